@@ -7,6 +7,11 @@
 #include "ioLib.h"
 #include "novelClean.h"
 #include "novelSort.h"
+#include "novelIndex.h"
+#include "novelIndexFile.h"
+#include "novelPipeline.h"
+#include "novelRhyme.h"
+#include "novelServer.h"
 #include "unitTests.h"
 
 enum TestingMode
@@ -17,43 +22,121 @@ enum TestingMode
 
 constexpr const char* INPUT_DEFAULT_FILENAME  = "res/onegin_raw_input.txt";
 constexpr const char* OUTPUT_DEFAULT_FILENAME = "res/onegin_output.txt";
-constexpr size_t      TITLE_MESSAGE_LENGTH    = 100;
 
-void dialogStart();
+void dialogStart(CodePage codePage);
+int  startServer(const char* const* fileNames, size_t numberOfFiles, CodePage codePage);
+int  findCodePage(const char* name, CodePage* codePage);
 char getOption(char first, char last);
-void dialogMain(bool printOriginal);
+void dialogMain(bool printOriginal, CodePage codePage);
+void dialogPreview(CodePage codePage);
+void dialogRhymes(CodePage codePage);
+size_t requestNumber(const char* message);
 int requestTwoFilenames(const char* message1,         const char* message2, 
                         const char* defaultFilename1, const char* defaultFilename2,
                         char**      filename1,        char**      filename2);
-void writeTitleMessage(File* outputFile, const char* message);
-void printStringBuffer(File* outputFile, string* strIndex, size_t numberOfLines);
-void initializeStrIndex(string* strIndex, unsigned char* stringBuffer,  size_t stringBufferSize);
-void sort(string* strIndex, size_t numberOfLines, File* outputFile, 
-          int (*compare)(const void* value1, const void* value2),
-          const char* message, int useDefaultQSort);
 
 int main(int argc, char* argv[])
 {
     setlocale(LC_ALL, "Russian");
 
     TestingMode testingMode = DISABLED;
+    size_t      serverArg   = 0;
+    CodePage    codePage    = DEFAULT_CODE_PAGE;
 
     for (size_t i = 0; i < argc; i++)
+    {
         if (strCompare((const unsigned char*)argv[i], (const unsigned char*)"-t") == 0)
             testingMode = ENABLED;
+        else if (serverArg == 0 && strCompare((const unsigned char*)argv[i], (const unsigned char*)"-c") == 0)
+        {
+            if (i + 1 == argc || findCodePage(argv[i + 1], &codePage) != 0)
+            {
+                consoleWriteFormatted("Unknown code page. Supported code pages:");
+                for (size_t j = 0; j < CODE_PAGES_NUMBER; j++)
+                    consoleWriteFormatted(" %s", CODE_PAGE_NAMES[j]);
+                consoleWriteFormatted("\n");
+                return -1;
+            }
+
+            i++;
+        }
+        else if (serverArg == 0 && strCompare((const unsigned char*)argv[i], (const unsigned char*)"-s") == 0)
+            serverArg = i;
+    }
 
     if (testingMode == ENABLED)
         testAll();
+    else if (serverArg != 0)
+        return startServer(argv + serverArg + 1, argc - serverArg - 1, codePage);
     else
-        dialogStart();
+        dialogStart(codePage);
 
     return 0;
 }
 
 //-----------------------------------------------------------------------------
-//! Starts the 'user interface'
+//! Server mode ("-s [file ...]"). Loads and sorts the novels once and then
+//! answers queries from stdin until "quit" (see answerServerQuery). If no
+//! files are given, loads the default input file.
+//!
+//! @param [in]  fileNames
+//! @param [in]  numberOfFiles
+//! @param [in]  codePage  encoding of the files
+//!
+//! @return 0 if there was no error and non-zero value otherwise.
+//-----------------------------------------------------------------------------
+int startServer(const char* const* fileNames, size_t numberOfFiles, CodePage codePage)
+{
+    if (numberOfFiles == 0)
+    {
+        fileNames     = &INPUT_DEFAULT_FILENAME;
+        numberOfFiles = 1;
+    }
+
+    NovelServer server = {};
+    if (initNovelServer(&server, fileNames, numberOfFiles, codePage) != 0)
+    {
+        consoleWriteFormatted("Couldn't load the novels\n");
+        return -1;
+    }
+
+    int result = runNovelServer(&server, stdin, stdout);
+    destroyNovelServer(&server);
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//! Finds code page by its name ("-c <name>", see CODE_PAGE_NAMES).
+//!
+//! @param [in]   name
+//! @param [out]  codePage
+//!
+//! @return 0 if there is such code page and non-zero value otherwise.
+//-----------------------------------------------------------------------------
+int findCodePage(const char* name, CodePage* codePage)
+{
+    if (name == NULL || codePage == NULL)
+        return -1;
+
+    for (size_t i = 0; i < CODE_PAGES_NUMBER; i++)
+    {
+        if (strCompare((const unsigned char*)name, (const unsigned char*)CODE_PAGE_NAMES[i]) == 0)
+        {
+            *codePage = (CodePage) i;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+//-----------------------------------------------------------------------------
+//! Starts the 'user interface'. Novels are read in codePage.
+//!
+//! @param [in]  codePage
 //-----------------------------------------------------------------------------
-void dialogStart()
+void dialogStart(CodePage codePage)
 {
     consoleWriteFormatted("\n=================================================\n"
                           "             What do you want to do?             \n"
@@ -61,25 +144,36 @@ void dialogStart()
                           "      sorted novels                              \n"
                           "  [1] generate an alphabetically and a reversly  \n"
                           "      sorted novels + print the original novel   \n"
-                          "  [2] test program                               \n"
-                          "  [3] EXIT                                       \n"
+                          "  [2] preview lines from i to j of the sorted    \n"
+                          "      novels                                     \n"
+                          "  [3] generate clusters of rhyming lines         \n"
+                          "  [4] test program                               \n"
+                          "  [5] EXIT                                       \n"
                           "=================================================\n"
                           "=================================================\n\n");
 
-    char mode = getOption('0', '3');
+    char mode = getOption('0', '5');
     switch(mode)
     {
         case '0':
-        dialogMain(0);
+        dialogMain(0, codePage);
         break;
 
         case '1':
-        dialogMain(1);
+        dialogMain(1, codePage);
         break;
 
         case '2':
+        dialogPreview(codePage);
+        break;
+
+        case '3':
+        dialogRhymes(codePage);
+        break;
+
+        case '4':
         testAll();
-        dialogStart();
+        dialogStart(codePage);
         break;
 
         default:
@@ -118,11 +212,17 @@ char getOption(char first, char last)
 
 //-----------------------------------------------------------------------------
 //! Main dialog. If printOriginal == 0, then doesn't print original raw novel,
-//! otherwise prints it.
+//! otherwise prints it. If there is an up to date index file next to the
+//! input file, the output is generated from it without cleaning and sorting.
+//! If text has only been appended to the input file since the index file was
+//! made, only the appended text is cleaned and sorted. Otherwise the index
+//! file is created anew. Duplicate lines can be removed from the sorted
+//! novels, in this case the index file isn't used.
 //!
 //! @param [in]  printOriginal
+//! @param [in]  codePage  encoding of the input file
 //-----------------------------------------------------------------------------
-void dialogMain(bool printOriginal)
+void dialogMain(bool printOriginal, CodePage codePage)
 {
     char* inputFileName  = (char*) calloc(MAX_LINE_LENGTH, sizeof(char));
     char* outputFileName = (char*) calloc(MAX_LINE_LENGTH, sizeof(char));
@@ -131,58 +231,188 @@ void dialogMain(bool printOriginal)
                         INPUT_DEFAULT_FILENAME,                 OUTPUT_DEFAULT_FILENAME,
                         &inputFileName,                         &outputFileName);
 
-    File* inputFile  = openFile(inputFileName,  'r');
+    consoleWriteFormatted("\n~Do you want to remove duplicate lines from the sorted novels?\n"
+                          "  [0] no\n"
+                          "  [1] yes\n");
+    bool removeDuplicates = getOption('0', '1') == '1';
+
     File* outputFile = openFile(outputFileName, 'w');
-    assert(inputFile  != NULL);
     assert(outputFile != NULL);
 
-    struct stat inputFileStat = {};
-    stat((char*)inputFileName, &inputFileStat);
-    size_t inputFileSize = (size_t) inputFileStat.st_size;
+    char* indexFileName = getIndexFileName(inputFileName);
+    assert(indexFileName != NULL);
 
-    unsigned char* inputFileBuffer = (unsigned char*) calloc(inputFileSize, sizeof(unsigned char));
-    unsigned char* stringBuffer    = (unsigned char*) calloc(inputFileSize, sizeof(unsigned char));
-    assert(readBufferFromFile(inputFile, sizeof(unsigned char), inputFileSize, inputFileBuffer) != FILE_END);
-    assert(inputFileBuffer != NULL && stringBuffer != NULL);
+    // index file keeps all of the lines, so it's not used when removing duplicates
+    NovelIndexFile indexFile = {};
+    if (!removeDuplicates &&
+        (loadNovelIndexFile  (indexFileName, inputFileName, codePage, &indexFile) == 0 ||
+         updateNovelIndexFile(indexFileName, inputFileName, codePage, &indexFile) == 0))
+    {
+        int writeResult = writeNovelFromIndexFile(outputFile, &indexFile, printOriginal ? inputFileName : NULL);
+        assert(writeResult == 0);
+
+        destroyNovelIndexFile(&indexFile);
+    }
+    else
+    {
+        PipelineOptions options = {};
+        options.printOriginal    = printOriginal;
+        options.removeDuplicates = removeDuplicates;
+        options.indexFileName    = removeDuplicates ? NULL : indexFileName;
+        options.codePage         = codePage;
+
+        int pipelineResult = runNovelPipeline(inputFileName, outputFile, &options);
+        assert(pipelineResult == 0);
+    }
+
+    free(indexFileName);
+
+    if (inputFileName  != INPUT_DEFAULT_FILENAME)
+        free(inputFileName);
+
+    closeFile(outputFile);
+
+    consoleWriteFormatted("\nEverything has been successfully generated!\n");
+
+    if (outputFileName != OUTPUT_DEFAULT_FILENAME)
+        free(outputFileName);
+}
+
+//-----------------------------------------------------------------------------
+//! Preview dialog. Writes only lines from i to j of the alphabetically and
+//! reversely sorted novels, which are sorted only as much as it's needed to
+//! get these lines.
+//!
+//! @param [in]  codePage  encoding of the input file
+//-----------------------------------------------------------------------------
+void dialogPreview(CodePage codePage)
+{
+    char* inputFileName  = (char*) calloc(MAX_LINE_LENGTH, sizeof(char));
+    char* outputFileName = (char*) calloc(MAX_LINE_LENGTH, sizeof(char));
+
+    requestTwoFilenames("\n~What file do you want to clean?\n", "\n~Into what file to write output?\n",
+                        INPUT_DEFAULT_FILENAME,                 OUTPUT_DEFAULT_FILENAME,
+                        &inputFileName,                         &outputFileName);
+
+    size_t firstLine = requestNumber("\n~Enter the number of the first line to preview (from 1): ");
+    size_t lastLine  = requestNumber("\n~Enter the number of the last line to preview: ");
+    if (firstLine == 0)
+        firstLine = 1;
+
+    Novel novel = {};
+    int loadResult = loadNovel(inputFileName, codePage, &novel);
+    assert(loadResult == 0);
 
-    closeFile(inputFile);
     if (inputFileName  != INPUT_DEFAULT_FILENAME)
         free(inputFileName);
 
-    // printing original novel
-    if (printOriginal)
+    File* outputFile = openFile(outputFileName, 'w');
+    assert(outputFile != NULL);
+
+    string* strIndex = (string*) calloc(novel.numberOfLines + 1, sizeof(string));
+    assert(strIndex != NULL);
+
+    const char* messages[] = { "Alphabetically sorted novel (preview)", "Reversely sorted novel (preview)" };
+    int (*comparators[])(const void*, const void*) = 
+        { getStrComparators(codePage)->alphabetically, getStrComparators(codePage)->reversely };
+
+    for (size_t i = 0; i < 2; i++)
     {
-        writeTitleMessage(outputFile, "Original novel");
-        writeBufferToFile(outputFile, sizeof(char), inputFileSize, inputFileBuffer);
+        for (size_t line = 0; line < novel.numberOfLines; line++)
+            strIndex[line] = novel.strIndex[line];
+
+        size_t previewLength = 0;
+        if (lastLine >= firstLine)
+            previewLength = sortStrIndexRange(strIndex, novel.numberOfLines, comparators[i], 
+                                              firstLine - 1, lastLine - 1);
+
+        writeTitleMessage(outputFile, messages[i]);
+        if (previewLength != 0)
+            printStringBuffer(outputFile, strIndex + firstLine - 1, previewLength);
     }
 
-    size_t stringBufferSize = cleanNovel         (inputFileBuffer, inputFileSize, stringBuffer);
-    size_t numberOfLines    = strNumOfOccurrences((const char*) stringBuffer, '\n');
+    closeFile(outputFile);
+
+    consoleWriteFormatted("\nPreview has been successfully generated!\n");
 
-    // initializing strIndex
-    string* strIndex = (string*) calloc(numberOfLines, sizeof(string));
-    assert(strIndex != NULL);
-    initializeStrIndex(strIndex, stringBuffer, stringBufferSize);
+    if (outputFileName != OUTPUT_DEFAULT_FILENAME)
+        free(outputFileName);
+
+    free(strIndex);
+    destroyNovel(&novel);
+}
+
+//-----------------------------------------------------------------------------
+//! Rhymes dialog. Writes groups of lines with the same endings.
+//!
+//! @param [in]  codePage  encoding of the input file
+//-----------------------------------------------------------------------------
+void dialogRhymes(CodePage codePage)
+{
+    char* inputFileName  = (char*) calloc(MAX_LINE_LENGTH, sizeof(char));
+    char* outputFileName = (char*) calloc(MAX_LINE_LENGTH, sizeof(char));
+
+    requestTwoFilenames("\n~What file do you want to clean?\n", "\n~Into what file to write output?\n",
+                        INPUT_DEFAULT_FILENAME,                 OUTPUT_DEFAULT_FILENAME,
+                        &inputFileName,                         &outputFileName);
+
+    Novel novel = {};
+    int loadResult = loadNovel(inputFileName, codePage, &novel);
+    assert(loadResult == 0);
+
+    if (inputFileName  != INPUT_DEFAULT_FILENAME)
+        free(inputFileName);
 
-    writeTitleMessage(outputFile, "Cleaned novel");
-    printStringBuffer(outputFile, strIndex, numberOfLines);
+    RhymeIndex rhymeIndex = {};
+    int buildResult = buildRhymeIndex(&rhymeIndex, novel.strIndex, novel.numberOfLines, codePage);
+    assert(buildResult == 0);
 
-    sort(strIndex, numberOfLines, outputFile, 
-        (int (*)(const void*, const void*)) &strCmpForSortAlphabetically, 
-         "Alphabetically sorted novel", 0);
-    sort(strIndex, numberOfLines, outputFile, 
-        (int (*)(const void*, const void*)) &strCmpForSortReversely, 
-         "Reversely sorted novel", 1);
+    File* outputFile = openFile(outputFileName, 'w');
+    assert(outputFile != NULL);
+
+    writeTitleMessage (outputFile, "Rhyme clusters");
+    writeRhymeClusters(outputFile, &rhymeIndex);
 
     closeFile(outputFile);
 
-    consoleWriteFormatted("\nEverything has been successfully generated!\n");
+    consoleWriteFormatted("\nRhyme clusters have been successfully generated!\n");
 
     if (outputFileName != OUTPUT_DEFAULT_FILENAME)
         free(outputFileName);
 
-    free(inputFileBuffer);
-    free(stringBuffer);
+    destroyRhymeIndex(&rhymeIndex);
+    destroyNovel(&novel);
+}
+
+//-----------------------------------------------------------------------------
+//! Asks user to enter a non-negative number. If input is incorrect asks to
+//! enter it again.
+//!
+//! @param [in]  message
+//!
+//! @return the number entered.
+//-----------------------------------------------------------------------------
+size_t requestNumber(const char* message)
+{
+    assert(message != NULL);
+
+    char  input[MAX_LINE_LENGTH] = {};
+    char* inputEnd               = NULL;
+
+    consoleWriteFormatted("%s", message);
+    consoleNextLine(input, MAX_LINE_LENGTH);
+    consoleMoveToNextLine();
+    size_t number = (size_t) strtoull(input, &inputEnd, 10);
+
+    while (inputEnd == input || input[0] == '-')
+    {
+        consoleWriteFormatted("  Incorrect input. Please enter a non-negative number: ");
+        consoleNextLine(input, MAX_LINE_LENGTH);
+        consoleMoveToNextLine();
+        number = (size_t) strtoull(input, &inputEnd, 10);
+    }
+
+    return number;
 }
 
 //-----------------------------------------------------------------------------
@@ -235,113 +465,3 @@ int requestTwoFilenames(const char* message1,         const char* message2,
 
     return 0;
 }
-
-//-----------------------------------------------------------------------------
-//! Writes message inside bars of size TITLE_MESSAGE_LENGTH to outputFile.
-//!
-//! @param [in]  outputFile
-//! @param [in]  message
-//-----------------------------------------------------------------------------
-void writeTitleMessage(File* outputFile, const char* message)
-{
-    assert(outputFile != NULL);
-    assert(message    != NULL);
-    
-    size_t length = strLength(message);
-
-    char* barLine = (char*) calloc(TITLE_MESSAGE_LENGTH + 4, sizeof(char)); // 4 = 3x'\n' + 1x'\0'
-    assert(barLine != NULL);
-    
-    barLine[0] = '\n';
-    for (size_t i = 1; i <= TITLE_MESSAGE_LENGTH; i++)
-        barLine[i] = '=';
-    barLine[TITLE_MESSAGE_LENGTH + 1] = '\n';
-    barLine[TITLE_MESSAGE_LENGTH + 2] = '\0';
-    writeString(outputFile, barLine);
-
-    for (size_t i = 0; i < (TITLE_MESSAGE_LENGTH - length) / 2; i++)
-        writeChar(outputFile, ' ');
-    writeLine(outputFile, message);
-
-    barLine[TITLE_MESSAGE_LENGTH + 2] = '\n';
-    barLine[TITLE_MESSAGE_LENGTH + 3] = '\0';
-    writeString(outputFile, barLine);
-
-    free(barLine);
-}
-
-//-----------------------------------------------------------------------------
-//! Prints strings from strIndex to outputFile.
-//!
-//! @param [in]  outputFile
-//! @param [in]  strIndex
-//! @param [in]  numberOfLines
-//-----------------------------------------------------------------------------
-void printStringBuffer(File* outputFile, string* strIndex, size_t numberOfLines)
-{
-    assert(outputFile    != NULL);
-    assert(strIndex      != NULL);
-    assert(numberOfLines != NULL);
-
-    for(size_t i = 0; i < numberOfLines; i++)
-    {
-        writeBufferToFile(outputFile, sizeof(unsigned char), strIndex[i].length, strIndex[i].str);
-        writeChar(outputFile, '\n');
-    }
-}
-
-//-----------------------------------------------------------------------------
-//! Initializes strIndex based on stringBuffer.
-//!
-//! @param [out] strIndex
-//! @param [in]  stringBuffer
-//! @param [in]  stringBufferSize
-//-----------------------------------------------------------------------------
-void initializeStrIndex(string* strIndex, unsigned char* stringBuffer, size_t stringBufferSize)
-{
-    assert(strIndex != NULL);
-
-    strIndex[0].str      = stringBuffer;
-    size_t currentLine   = 1;
-    size_t lastLineStart = 0;
-
-    size_t i = 1;
-    for (; i < stringBufferSize - 1; i++)
-    {
-        if (stringBuffer[i - 1] == '\n' && stringBuffer[i] != '\n')
-        {
-            strIndex[currentLine].str = &stringBuffer[i];
-            strIndex[currentLine - 1].length = i - lastLineStart - 1;
-            lastLineStart = i;
-            currentLine++;
-        }
-    }
-
-    strIndex[currentLine - 1].length = i - lastLineStart - 1;
-}
-
-//-----------------------------------------------------------------------------
-//! Sorts strIndex and writes the result to outputFile. If useDefaultQSort is 0
-//! then uses qsort from novelSort.h otherwise uses standard qsort. 
-//!
-//! @param [out] strIndex
-//! @param [in]  numberOfLines
-//! @param [out] outputFile
-//! @param [in]  compare
-//! @param [in]  message
-//! @param [in]  useDefaultQSort
-//-----------------------------------------------------------------------------
-void sort(string* strIndex, size_t numberOfLines, File* outputFile, 
-          int (*compare)(const void* value1, const void* value2),
-          const char* message, int useDefaultQSort)
-{
-    setStringTermination('\n');
-    if (useDefaultQSort)
-        qsort((void*) strIndex, numberOfLines, sizeof(string), compare);
-    else
-        qsort((void*) strIndex, 0, numberOfLines - 1, sizeof(string), compare);
-    setStringTermination('\0');
-
-    writeTitleMessage(outputFile, message);
-    printStringBuffer(outputFile, strIndex, numberOfLines);
-}
\ No newline at end of file
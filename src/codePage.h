@@ -0,0 +1,264 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+
+//-----------------------------------------------------------------------------
+//! Supported single-byte encodings of the novels.
+//-----------------------------------------------------------------------------
+enum CodePage
+{
+    CODE_PAGE_CP1251,
+    CODE_PAGE_KOI8_R,
+    CODE_PAGE_ISO_8859_5
+};
+
+constexpr CodePage DEFAULT_CODE_PAGE         = CODE_PAGE_CP1251;
+constexpr size_t   CODE_PAGES_NUMBER         = 3;
+constexpr size_t   ALPHABET_LENGTH           = 33;
+constexpr size_t   YO_LETTER_INDEX           = 6;
+constexpr size_t   MAX_EXTRA_PUNCTUATION     = 16;
+constexpr uint16_t CYRILIC_COLLATION_WEIGHT  = 0x100;
+
+constexpr uint8_t  SYMBOL_CYRILIC_LETTER     = 1 << 0;
+constexpr uint8_t  SYMBOL_LATIN_LETTER       = 1 << 1;
+constexpr uint8_t  SYMBOL_PUNCTUATION_MARK   = 1 << 2;
+
+// in the order of CodePage
+constexpr const char* CODE_PAGE_NAMES[CODE_PAGES_NUMBER] = { "cp1251", "koi8-r", "iso-8859-5" };
+
+//-----------------------------------------------------------------------------
+//! Where the letters of the russian alphabet are in a code page: lower[i]
+//! and upper[i] are the i-th letter of the alphabet (yo is the 7th one, right
+//! after ye). extraPunctuation are the punctuation marks of the code page
+//! out of ASCII (quotes, dashes, no-break space etc.).
+//-----------------------------------------------------------------------------
+struct CodePageLetters
+{
+    unsigned char lower           [ALPHABET_LENGTH]       = {};
+    unsigned char upper           [ALPHABET_LENGTH]       = {};
+    unsigned char extraPunctuation[MAX_EXTRA_PUNCTUATION] = {};
+    size_t        extraPunctuationCount                   = 0;
+};
+
+// in the order of CodePage
+constexpr CodePageLetters CODE_PAGE_LETTERS[CODE_PAGES_NUMBER] =
+{
+    // CP1251
+    { { 0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xB8, 0xE6, 0xE7, 0xE8, 0xE9,
+        0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF, 0xF0, 0xF1, 0xF2, 0xF3, 0xF4,
+        0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF },
+      { 0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xA8, 0xC6, 0xC7, 0xC8, 0xC9,
+        0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF, 0xD0, 0xD1, 0xD2, 0xD3, 0xD4,
+        0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF },
+      { 0x84, 0x85, 0x8B, 0x91, 0x92, 0x93, 0x94, 0x96, 0x97, 0x9B, 0xA0,
+        0xAB, 0xAD, 0xB7, 0xB9, 0xBB }, 16 },
+
+    // KOI8-R
+    { { 0xC1, 0xC2, 0xD7, 0xC7, 0xC4, 0xC5, 0xA3, 0xD6, 0xDA, 0xC9, 0xCA,
+        0xCB, 0xCC, 0xCD, 0xCE, 0xCF, 0xD0, 0xD2, 0xD3, 0xD4, 0xD5, 0xC6,
+        0xC8, 0xC3, 0xDE, 0xDB, 0xDD, 0xDF, 0xD9, 0xD8, 0xDC, 0xC0, 0xD1 },
+      { 0xE1, 0xE2, 0xF7, 0xE7, 0xE4, 0xE5, 0xB3, 0xF6, 0xFA, 0xE9, 0xEA,
+        0xEB, 0xEC, 0xED, 0xEE, 0xEF, 0xF0, 0xF2, 0xF3, 0xF4, 0xF5, 0xE6,
+        0xE8, 0xE3, 0xFE, 0xFB, 0xFD, 0xFF, 0xF9, 0xF8, 0xFC, 0xE0, 0xF1 },
+      { 0x9A, 0x9E }, 2 },
+
+    // ISO-8859-5
+    { { 0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xF1, 0xD6, 0xD7, 0xD8, 0xD9,
+        0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF, 0xE0, 0xE1, 0xE2, 0xE3, 0xE4,
+        0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF },
+      { 0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xA1, 0xB6, 0xB7, 0xB8, 0xB9,
+        0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF, 0xC0, 0xC1, 0xC2, 0xC3, 0xC4,
+        0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF },
+      { 0xA0, 0xAD, 0xF0 }, 3 }
+};
+
+//-----------------------------------------------------------------------------
+//! Classification and collation of every symbol of a code page:
+//!   classes    - SYMBOL_* bits
+//!   lowerCases - the symbol in lower case
+//!   weights    - order of the symbol in the sorted novels. Upper and lower
+//!                case letters have equal weights, cyrilic letters go after
+//!                all of the other symbols in the order of the alphabet, yo
+//!                right after ye. Symbols skipped by the comparators
+//!                (punctuation marks and latin letters) have weight 0.
+//-----------------------------------------------------------------------------
+struct CodePageTable
+{
+    uint8_t       classes   [256] = {};
+    unsigned char lowerCases[256] = {};
+    uint16_t      weights   [256] = {};
+};
+
+//-----------------------------------------------------------------------------
+//! Generates the table of a code page at compile time.
+//!
+//! @param [in]  letters
+//!
+//! @return the table.
+//-----------------------------------------------------------------------------
+constexpr CodePageTable makeCodePageTable(const CodePageLetters& letters)
+{
+    CodePageTable table = {};
+
+    for (size_t symbol = 0; symbol < 256; symbol++)
+    {
+        table.lowerCases[symbol] = (unsigned char) symbol;
+        table.weights   [symbol] = (uint16_t)      symbol;
+
+        if ((symbol >= 'a' && symbol <= 'z') || (symbol >= 'A' && symbol <= 'Z'))
+        {
+            table.classes   [symbol] = SYMBOL_LATIN_LETTER;
+            table.lowerCases[symbol] = (unsigned char) (symbol | 0x20);
+        }
+        else if (symbol == ' ' || (symbol >= '!' && symbol <= '/') || (symbol >= ':' && symbol <= '@') ||
+                 (symbol >= '[' && symbol <= '`') || (symbol >= '{' && symbol <= '~'))
+        {
+            table.classes[symbol] = SYMBOL_PUNCTUATION_MARK;
+        }
+    }
+
+    for (size_t i = 0; i < letters.extraPunctuationCount; i++)
+        table.classes[letters.extraPunctuation[i]] = SYMBOL_PUNCTUATION_MARK;
+
+    for (size_t i = 0; i < ALPHABET_LENGTH; i++)
+    {
+        table.classes   [letters.lower[i]] = SYMBOL_CYRILIC_LETTER;
+        table.classes   [letters.upper[i]] = SYMBOL_CYRILIC_LETTER;
+        table.lowerCases[letters.upper[i]] = letters.lower[i];
+        table.weights   [letters.lower[i]] = (uint16_t) (CYRILIC_COLLATION_WEIGHT + i);
+        table.weights   [letters.upper[i]] = (uint16_t) (CYRILIC_COLLATION_WEIGHT + i);
+    }
+
+    for (size_t symbol = 0; symbol < 256; symbol++)
+        if (table.classes[symbol] & (SYMBOL_LATIN_LETTER | SYMBOL_PUNCTUATION_MARK))
+            table.weights[symbol] = 0;
+
+    return table;
+}
+
+template <CodePage codePage>
+constexpr CodePageTable CODE_PAGE_TABLE = makeCodePageTable(CODE_PAGE_LETTERS[codePage]);
+
+//-----------------------------------------------------------------------------
+//! @return true if symbol is a cyrilic letter in codePage.
+//-----------------------------------------------------------------------------
+template <CodePage codePage>
+constexpr bool isCyrilicSymbol(unsigned char symbol)
+{
+    return CODE_PAGE_TABLE<codePage>.classes[symbol] & SYMBOL_CYRILIC_LETTER;
+}
+
+//-----------------------------------------------------------------------------
+//! @return collation weight of symbol in codePage (0 if it's skipped by the
+//!         comparators).
+//-----------------------------------------------------------------------------
+template <CodePage codePage>
+constexpr uint16_t collationWeight(unsigned char symbol)
+{
+    return CODE_PAGE_TABLE<codePage>.weights[symbol];
+}
+
+//-----------------------------------------------------------------------------
+//! @return symbol in lower case in codePage.
+//-----------------------------------------------------------------------------
+template <CodePage codePage>
+constexpr unsigned char lowerCaseSymbol(unsigned char symbol)
+{
+    return CODE_PAGE_TABLE<codePage>.lowerCases[symbol];
+}
+
+//-----------------------------------------------------------------------------
+//! Where the upper case letters of a code page are, so that many symbols can
+//! be turned into lower case at once: all of them but yo are from upperFirst
+//! to upperFirst + ALPHABET_LENGTH - 2 and become lower case when lowerOffset
+//! is added to them (modulo 256).
+//-----------------------------------------------------------------------------
+struct CaseFolding
+{
+    unsigned char upperFirst  = 0;
+    unsigned char lowerOffset = 0;
+    unsigned char upperYo     = 0;
+    unsigned char lowerYo     = 0;
+};
+
+//-----------------------------------------------------------------------------
+//! Generates the case folding of a code page at compile time.
+//!
+//! @param [in]  letters
+//!
+//! @return the case folding.
+//-----------------------------------------------------------------------------
+constexpr CaseFolding makeCaseFolding(const CodePageLetters& letters)
+{
+    CaseFolding folding = {};
+
+    folding.upperFirst  = 0xFF;
+    folding.lowerOffset = (unsigned char) (letters.lower[0] - letters.upper[0]);
+    folding.upperYo     = letters.upper[YO_LETTER_INDEX];
+    folding.lowerYo     = letters.lower[YO_LETTER_INDEX];
+
+    for (size_t i = 0; i < ALPHABET_LENGTH; i++)
+        if (i != YO_LETTER_INDEX && letters.upper[i] < folding.upperFirst)
+            folding.upperFirst = letters.upper[i];
+
+    return folding;
+}
+
+template <CodePage codePage>
+constexpr CaseFolding CASE_FOLDING = makeCaseFolding(CODE_PAGE_LETTERS[codePage]);
+
+//-----------------------------------------------------------------------------
+//! Turns symbol into a key, such that symbols with equal keys have equal
+//! collation weights: upper case letters are turned into lower case, ASCII
+//! symbols skipped by the comparators (all of the printable ones except
+//! digits) are turned into 0, the rest are left as they are. It's simple
+//! enough to be done for many symbols at once (see commonPrefixLength).
+//!
+//! @param [in]  symbol
+//!
+//! @return the key.
+//-----------------------------------------------------------------------------
+template <CodePage codePage>
+constexpr unsigned char foldSymbol(unsigned char symbol)
+{
+    constexpr CaseFolding folding = CASE_FOLDING<codePage>;
+
+    if (symbol >= ' ' && symbol <= '~' && !(symbol >= '0' && symbol <= '9'))
+        return 0;
+
+    if (symbol == folding.upperYo)
+        return folding.lowerYo;
+
+    if ((unsigned char) (symbol - folding.upperFirst) <= ALPHABET_LENGTH - 2)
+        return (unsigned char) (symbol + folding.lowerOffset);
+
+    return symbol;
+}
+
+//-----------------------------------------------------------------------------
+//! @return true if foldSymbol keeps the collation weights of all of the
+//!         symbols of codePage.
+//-----------------------------------------------------------------------------
+template <CodePage codePage>
+constexpr bool isCaseFoldingValid()
+{
+    for (size_t symbol = 0; symbol < 256; symbol++)
+        if (collationWeight<codePage>(foldSymbol<codePage>((unsigned char) symbol)) !=
+            collationWeight<codePage>((unsigned char) symbol))
+            return false;
+
+    return true;
+}
+
+static_assert(isCaseFoldingValid<CODE_PAGE_CP1251>() && isCaseFoldingValid<CODE_PAGE_KOI8_R>() &&
+              isCaseFoldingValid<CODE_PAGE_ISO_8859_5>(),
+              "upper case letters have to be in one range and punctuation marks have to be skipped");
+
+static_assert(collationWeight<CODE_PAGE_CP1251>    (0xE5) < collationWeight<CODE_PAGE_CP1251>    (0xB8) &&
+              collationWeight<CODE_PAGE_CP1251>    (0xB8) < collationWeight<CODE_PAGE_CP1251>    (0xE6),
+              "yo has to go between ye and zhe");
+static_assert(collationWeight<CODE_PAGE_KOI8_R>    (0xB3) == collationWeight<CODE_PAGE_KOI8_R>   (0xA3),
+              "upper and lower case yo have to be equal");
+static_assert(collationWeight<CODE_PAGE_ISO_8859_5>(0x2C) == 0,
+              "punctuation marks have to be skipped");
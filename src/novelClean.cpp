@@ -1,4 +1,5 @@
 #include<stdlib.h>
+#include<assert.h>
 
 #include "novelClean.h"
 
@@ -22,22 +23,50 @@ void skipLine(unsigned char** currentSymbol)
 //! @param [in]   inputFileBuffer  
 //! @param [in]   inputFileSize
 //! @param [out]  outputBuffer
+//! @param [in]   codePage  encoding of the novel
 //! 
 //! @return number of characters in outputBuffer.
 //-----------------------------------------------------------------------------
-size_t cleanNovel(unsigned char* inputFileBuffer, size_t inputFileSize, unsigned char* outputBuffer)
+size_t cleanNovel(unsigned char* inputFileBuffer, size_t inputFileSize, unsigned char* outputBuffer,
+                  CodePage codePage)
 {
     if (inputFileBuffer == NULL || outputBuffer == NULL)
         return 1;
 
-    unsigned char* currentSymbol              = inputFileBuffer;
-    unsigned char* currentOutputSymbol        = outputBuffer;
+    size_t outputSize = cleanNovelChunk(inputFileBuffer, inputFileSize, outputBuffer, codePage);
 
-    bool           isThereCyrilicLetterInLine = 0;
-    unsigned char* currentLineStart           = outputBuffer;
-    unsigned char* versePointer               = NULL;
-    unsigned char* newLinePointer             = NULL;
-    while ((size_t) (currentSymbol - inputFileBuffer) < inputFileSize)
+    outputBuffer[outputSize] = '\0';
+
+    return outputSize + 1;
+}
+
+//-----------------------------------------------------------------------------
+//! Cleans a chunk of novel the same way cleanNovel does, but doesn't terminate
+//! the output, so that consecutive chunks can be cleaned into one buffer. The
+//! end of the chunk is treated as the end of its last line, so every kept line
+//! gets '\n' in outputBuffer. Letters are looked up in codePage table.
+//!
+//! @param [in]   chunk  
+//! @param [in]   chunkSize
+//! @param [out]  outputBuffer
+//! 
+//! @return number of characters written to outputBuffer.
+//-----------------------------------------------------------------------------
+template <CodePage codePage>
+size_t cleanNovelChunk(const unsigned char* chunk, size_t chunkSize, unsigned char* outputBuffer)
+{
+    if (chunk == NULL || outputBuffer == NULL)
+        return 0;
+
+    const unsigned char* currentSymbol              = chunk;
+    const unsigned char* chunkEnd                   = chunk + chunkSize;
+    unsigned char*       currentOutputSymbol        = outputBuffer;
+
+    bool                 isThereCyrilicLetterInLine = 0;
+    const unsigned char* currentLineStart           = chunk;
+    const unsigned char* versePointer               = NULL;
+    const unsigned char* newLinePointer             = NULL;
+    while (currentSymbol < chunkEnd)
     {
         isThereCyrilicLetterInLine = 0;
         currentLineStart           = currentSymbol;
@@ -49,21 +78,31 @@ size_t cleanNovel(unsigned char* inputFileBuffer, size_t inputFileSize, unsigned
             continue;
         }
 
-        versePointer   = (unsigned char*) strFind((const char*)currentLineStart, 
-                                                  (const char*)CHAPTER_CODE_WORD, 
-                                                  MAX_LINE_LENGTH);
-        newLinePointer = (unsigned char*) strFind((const char*)currentLineStart, 
-                                                  (const char*)"\n",             
-                                                  MAX_LINE_LENGTH);
+        // the last line may have no '\n', so the search can't go past the chunk
+        size_t searchLength = (size_t) (chunkEnd - currentLineStart) < MAX_LINE_LENGTH ? 
+                              (size_t) (chunkEnd - currentLineStart) : MAX_LINE_LENGTH;
+
+        versePointer   = (const unsigned char*) strFind((const char*)currentLineStart, 
+                                                        CHAPTER_CODE_WORDS[codePage], 
+                                                        searchLength);
+        newLinePointer = (const unsigned char*) strFind((const char*)currentLineStart, 
+                                                        (const char*)"\n",             
+                                                        searchLength);
+        if (newLinePointer == NULL && searchLength < MAX_LINE_LENGTH)
+            newLinePointer = chunkEnd;
+
         if (versePointer != NULL && newLinePointer != NULL && versePointer < newLinePointer)
         {
-            skipLine(&currentSymbol);
+            while (currentSymbol < chunkEnd && *currentSymbol != '\n')
+                currentSymbol++;
+
+            currentSymbol++;
             continue;
         }
 
-        while (*currentSymbol != '\n')
+        while (currentSymbol < chunkEnd && *currentSymbol != '\n')
         {
-            if (isCyrilicLetter(*currentSymbol))
+            if (isCyrilicSymbol<codePage>(*currentSymbol))
                 isThereCyrilicLetterInLine = 1;
 
             *currentOutputSymbol = *currentSymbol;
@@ -79,8 +118,245 @@ size_t cleanNovel(unsigned char* inputFileBuffer, size_t inputFileSize, unsigned
         currentSymbol++;
     }
 
-    *(currentOutputSymbol - 1) = '\n';
-    *currentOutputSymbol = '\0';
+    return currentOutputSymbol - outputBuffer;
+}
+
+template size_t cleanNovelChunk<CODE_PAGE_CP1251>    (const unsigned char* chunk, size_t chunkSize,
+                                                      unsigned char* outputBuffer);
+template size_t cleanNovelChunk<CODE_PAGE_KOI8_R>    (const unsigned char* chunk, size_t chunkSize,
+                                                      unsigned char* outputBuffer);
+template size_t cleanNovelChunk<CODE_PAGE_ISO_8859_5>(const unsigned char* chunk, size_t chunkSize,
+                                                      unsigned char* outputBuffer);
+
+// in the order of CodePage
+static size_t (* const CHUNK_CLEANERS[CODE_PAGES_NUMBER])(const unsigned char* chunk, size_t chunkSize,
+                                                          unsigned char* outputBuffer) =
+    { cleanNovelChunk<CODE_PAGE_CP1251>, cleanNovelChunk<CODE_PAGE_KOI8_R>, cleanNovelChunk<CODE_PAGE_ISO_8859_5> };
+
+//-----------------------------------------------------------------------------
+//! Cleans a chunk of novel in codePage chosen at run time (see the template
+//! cleanNovelChunk).
+//!
+//! @param [in]   chunk  
+//! @param [in]   chunkSize
+//! @param [out]  outputBuffer
+//! @param [in]   codePage
+//! 
+//! @return number of characters written to outputBuffer.
+//-----------------------------------------------------------------------------
+size_t cleanNovelChunk(const unsigned char* chunk, size_t chunkSize, unsigned char* outputBuffer,
+                       CodePage codePage)
+{
+    assert(codePage < CODE_PAGES_NUMBER);
+
+    return CHUNK_CLEANERS[codePage](chunk, chunkSize, outputBuffer);
+}
+
+//-----------------------------------------------------------------------------
+//! FNV-1a hash of line, normalized the same way strCmpAlphabetically<codePage>
+//! compares lines, so that lines equal for it have equal hashes.
+//!
+//! @param [in]  line
+//! 
+//! @return hash.
+//-----------------------------------------------------------------------------
+template <CodePage codePage>
+size_t hashLine(const string* line)
+{
+    assert(line != NULL);
+
+    size_t hash = 2166136261u;
+    for (size_t i = 0; i < line->length; i++)
+    {
+        uint16_t weight = collationWeight<codePage>(line->str[i]);
+        if (weight == 0)
+            continue;
+
+        hash = (hash ^ weight) * 16777619u;
+    }
+
+    return hash;
+}
+
+template size_t hashLine<CODE_PAGE_CP1251>    (const string* line);
+template size_t hashLine<CODE_PAGE_KOI8_R>    (const string* line);
+template size_t hashLine<CODE_PAGE_ISO_8859_5>(const string* line);
+
+// in the order of CodePage
+static size_t (* const LINE_HASHES[CODE_PAGES_NUMBER])(const string* line) =
+    { hashLine<CODE_PAGE_CP1251>, hashLine<CODE_PAGE_KOI8_R>, hashLine<CODE_PAGE_ISO_8859_5> };
+
+//-----------------------------------------------------------------------------
+//! Initializes empty lineSet of lines in codePage.
+//!
+//! @param [out]  lineSet
+//! @param [in]   expectedSize  number of lines expected to be inserted
+//! @param [in]   codePage
+//! 
+//! @return 0 if there was no error and non-zero value otherwise.
+//-----------------------------------------------------------------------------
+int lineSetInit(LineSet* lineSet, size_t expectedSize, CodePage codePage)
+{
+    if (lineSet == NULL || codePage >= CODE_PAGES_NUMBER)
+        return -1;
+
+    *lineSet = {};
+    lineSet->hash    = LINE_HASHES[codePage];
+    lineSet->compare = getStrComparators(codePage)->alphabetically;
+
+    lineSet->capacity = LINE_SET_INITIAL_CAPACITY;
+    while (lineSet->capacity < 2 * expectedSize)
+        lineSet->capacity *= 2;
+
+    lineSet->slots = (LineSetSlot*) calloc(lineSet->capacity, sizeof(LineSetSlot));
+    if (lineSet->slots == NULL)
+        return -1;
+
+    return 0;
+}
 
-    return currentOutputSymbol - outputBuffer + 1;
-}
\ No newline at end of file
+//-----------------------------------------------------------------------------
+//! Looks for the slot of line in slots.
+//!
+//! @param [in]  slots
+//! @param [in]  capacity  power of 2
+//! @param [in]  line
+//! @param [in]  hash
+//! @param [in]  compare
+//! 
+//! @return slot with line equal to the given one or empty slot where it should
+//!         be.
+//-----------------------------------------------------------------------------
+static LineSetSlot* findLineSetSlot(LineSetSlot* slots, size_t capacity, const string* line, size_t hash,
+                                    int (*compare)(const void* str1, const void* str2))
+{
+    assert(slots   != NULL);
+    assert(line    != NULL);
+    assert(compare != NULL);
+
+    size_t slot = hash & (capacity - 1);
+    while (slots[slot].line.str != NULL &&
+           (slots[slot].hash != hash || compare(&slots[slot].line, line) != 0))
+        slot = (slot + 1) & (capacity - 1);
+
+    return &slots[slot];
+}
+
+//-----------------------------------------------------------------------------
+//! Inserts line into lineSet or counts one more occurrence of it if there is
+//! an equal line already. line->str must not be NULL and must live as long as
+//! lineSet does.
+//!
+//! @param [out]  lineSet
+//! @param [in]   line
+//! 
+//! @return 1 if line has been inserted, 0 if it's a duplicate and negative
+//!         value if there was an error.
+//-----------------------------------------------------------------------------
+int lineSetInsert(LineSet* lineSet, const string* line)
+{
+    assert(lineSet    != NULL);
+    assert(line       != NULL);
+    assert(line->str  != NULL);
+
+    if (2 * (lineSet->size + 1) > lineSet->capacity)
+    {
+        size_t       newCapacity = lineSet->capacity * 2;
+        LineSetSlot* newSlots    = (LineSetSlot*) calloc(newCapacity, sizeof(LineSetSlot));
+        if (newSlots == NULL)
+            return -1;
+
+        for (size_t i = 0; i < lineSet->capacity; i++)
+            if (lineSet->slots[i].line.str != NULL)
+                *findLineSetSlot(newSlots, newCapacity, &lineSet->slots[i].line, lineSet->slots[i].hash,
+                                 lineSet->compare) = lineSet->slots[i];
+
+        free(lineSet->slots);
+        lineSet->slots    = newSlots;
+        lineSet->capacity = newCapacity;
+    }
+
+    size_t       hash = lineSet->hash(line);
+    LineSetSlot* slot = findLineSetSlot(lineSet->slots, lineSet->capacity, line, hash, lineSet->compare);
+
+    slot->occurrences++;
+    if (slot->line.str != NULL)
+        return 0;
+
+    slot->line = *line;
+    slot->hash = hash;
+    lineSet->size++;
+
+    return 1;
+}
+
+//-----------------------------------------------------------------------------
+//! Frees memory allocated by lineSetInit.
+//!
+//! @param [out]  lineSet
+//-----------------------------------------------------------------------------
+void lineSetDestroy(LineSet* lineSet)
+{
+    if (lineSet == NULL)
+        return;
+
+    free(lineSet->slots);
+    *lineSet = {};
+}
+
+//-----------------------------------------------------------------------------
+//! Removes lines equal (for the alphabetical comparator of codePage) to some
+//! of the previous lines from strIndex keeping the order of the rest. Takes
+//! O(numberOfLines) on average.
+//!
+//! @param [out]     strIndex
+//! @param [in,out]  numberOfLines  number of lines left on return
+//! @param [out]     occurrences    number of occurrences of each line left,
+//!                                 may be NULL
+//! @param [in]      codePage
+//! 
+//! @return 0 if there was no error and non-zero value otherwise. If there was
+//!         an error, only the lines before it are checked for duplicates and
+//!         occurrences isn't filled.
+//-----------------------------------------------------------------------------
+int removeDuplicates(string* strIndex, size_t* numberOfLines, size_t* occurrences, CodePage codePage)
+{
+    assert(numberOfLines != NULL);
+    assert(strIndex != NULL || *numberOfLines == 0);
+
+    LineSet lineSet = {};
+    if (lineSetInit(&lineSet, *numberOfLines, codePage) != 0)
+        return -1;
+
+    size_t uniqueLines = 0;
+    for (size_t i = 0; i < *numberOfLines; i++)
+    {
+        int inserted = lineSetInsert(&lineSet, &strIndex[i]);
+        if (inserted < 0)
+        {
+            // keeping the rest of the lines as they are
+            for (; i < *numberOfLines; i++)
+                strIndex[uniqueLines++] = strIndex[i];
+
+            *numberOfLines = uniqueLines;
+            lineSetDestroy(&lineSet);
+            return -1;
+        }
+
+        if (inserted)
+            strIndex[uniqueLines++] = strIndex[i];
+    }
+
+    *numberOfLines = uniqueLines;
+
+    if (occurrences != NULL)
+    {
+        for (size_t i = 0; i < uniqueLines; i++)
+            occurrences[i] = findLineSetSlot(lineSet.slots, lineSet.capacity, &strIndex[i], 
+                                             lineSet.hash(&strIndex[i]), lineSet.compare)->occurrences;
+    }
+
+    lineSetDestroy(&lineSet);
+
+    return 0;
+}
@@ -1,9 +1,51 @@
 #pragma once
 
 #include "ioLib.h"
+#include "novelSort.h"
 
-constexpr const char* CHAPTER_CODE_WORD = " ";
 constexpr size_t      MAX_LINE_LENGTH   = 128; 
+constexpr size_t      LINE_SET_INITIAL_CAPACITY = 1024;
 
-void   skipLine   (unsigned char** currentSymbol);
-size_t cleanNovel (unsigned char* inputFileBuffer, size_t inputFileSize, unsigned char* outputBuffer);
+// chapter code word " " in every code page in the order of CodePage
+constexpr const char* CHAPTER_CODE_WORDS[CODE_PAGES_NUMBER] =
+    { " ", "\xE7\xCC\xC1\xD7\xC1 ", "\xB3\xDB\xD0\xD2\xD0 " };
+
+//-----------------------------------------------------------------------------
+//! Slot of LineSet. Empty slots have line.str == NULL.
+//-----------------------------------------------------------------------------
+struct LineSetSlot
+{
+    string line        = {};
+    size_t hash        = 0;
+    size_t occurrences = 0;
+};
+
+//-----------------------------------------------------------------------------
+//! Set of lines compared the same way the alphabetical comparator of a code
+//! page compares them (punctuation marks, latin letters and case are
+//! ignored). It's an open addressing hash table with linear probing. hash and
+//! compare are chosen by lineSetInit for the code page.
+//-----------------------------------------------------------------------------
+struct LineSet
+{
+    LineSetSlot* slots    = NULL;
+    size_t       capacity = 0;
+    size_t       size     = 0;
+
+    size_t     (*hash)   (const string* line)                 = NULL;
+    int        (*compare)(const void* str1, const void* str2) = NULL;
+};
+
+void   skipLine        (unsigned char** currentSymbol);
+size_t cleanNovel      (unsigned char* inputFileBuffer, size_t inputFileSize, unsigned char* outputBuffer,
+                        CodePage codePage);
+template <CodePage codePage>
+size_t cleanNovelChunk (const unsigned char* chunk, size_t chunkSize, unsigned char* outputBuffer);
+size_t cleanNovelChunk (const unsigned char* chunk, size_t chunkSize, unsigned char* outputBuffer,
+                        CodePage codePage);
+template <CodePage codePage>
+size_t hashLine        (const string* line);
+int    lineSetInit     (LineSet* lineSet, size_t expectedSize, CodePage codePage);
+int    lineSetInsert   (LineSet* lineSet, const string* line);
+void   lineSetDestroy  (LineSet* lineSet);
+int    removeDuplicates(string* strIndex, size_t* numberOfLines, size_t* occurrences, CodePage codePage);
@@ -0,0 +1,202 @@
+#include <stdlib.h>
+#include <assert.h>
+#include <sys/stat.h>
+
+#include "novelClean.h"
+#include "novelIndex.h"
+
+//-----------------------------------------------------------------------------
+//! Writes message inside bars of size TITLE_MESSAGE_LENGTH to outputFile.
+//!
+//! @param [in]  outputFile
+//! @param [in]  message
+//-----------------------------------------------------------------------------
+void writeTitleMessage(File* outputFile, const char* message)
+{
+    assert(outputFile != NULL);
+    assert(message    != NULL);
+    
+    size_t length = strLength(message);
+
+    char* barLine = (char*) calloc(TITLE_MESSAGE_LENGTH + 4, sizeof(char)); // 4 = 3x'\n' + 1x'\0'
+    assert(barLine != NULL);
+    
+    barLine[0] = '\n';
+    for (size_t i = 1; i <= TITLE_MESSAGE_LENGTH; i++)
+        barLine[i] = '=';
+    barLine[TITLE_MESSAGE_LENGTH + 1] = '\n';
+    barLine[TITLE_MESSAGE_LENGTH + 2] = '\0';
+    writeString(outputFile, barLine);
+
+    for (size_t i = 0; i < (TITLE_MESSAGE_LENGTH - length) / 2; i++)
+        writeChar(outputFile, ' ');
+    writeLine(outputFile, message);
+
+    barLine[TITLE_MESSAGE_LENGTH + 2] = '\n';
+    barLine[TITLE_MESSAGE_LENGTH + 3] = '\0';
+    writeString(outputFile, barLine);
+
+    free(barLine);
+}
+
+//-----------------------------------------------------------------------------
+//! Prints strings from strIndex to outputFile.
+//!
+//! @param [in]  outputFile
+//! @param [in]  strIndex
+//! @param [in]  numberOfLines
+//-----------------------------------------------------------------------------
+void printStringBuffer(File* outputFile, string* strIndex, size_t numberOfLines)
+{
+    assert(outputFile    != NULL);
+    assert(strIndex      != NULL);
+    assert(numberOfLines != NULL);
+
+    for(size_t i = 0; i < numberOfLines; i++)
+    {
+        writeBufferToFile(outputFile, sizeof(unsigned char), strIndex[i].length, strIndex[i].str);
+        writeChar(outputFile, '\n');
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Sorts strings from strIndex using compare and prints them to outputFile at
+//! the same time. Every string is printed as soon as its place in the sorted
+//! order is known, so the first one is printed after O(numberOfLines) work.
+//!
+//! @param [in]   outputFile
+//! @param [out]  strIndex
+//! @param [in]   numberOfLines
+//! @param [in]   compare
+//!
+//! @return 0 if there was no error and non-zero value otherwise.
+//-----------------------------------------------------------------------------
+int printSortedStringBuffer(File* outputFile, string* strIndex, size_t numberOfLines,
+                            int (*compare)(const void* value1, const void* value2))
+{
+    assert(outputFile != NULL);
+    assert(strIndex   != NULL);
+    assert(compare    != NULL);
+
+    SortedIterator iterator = {};
+    if (sortedIteratorInit(&iterator, strIndex, numberOfLines, sizeof(string), compare) != 0)
+        return -1;
+
+    string* line = NULL;
+    while ((line = (string*) sortedIteratorNext(&iterator)) != NULL)
+    {
+        writeBufferToFile(outputFile, sizeof(unsigned char), line->length, line->str);
+        writeChar(outputFile, '\n');
+    }
+
+    int result = iterator.error;
+    sortedIteratorDestroy(&iterator);
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//! Initializes strIndex based on stringBuffer.
+//!
+//! @param [out] strIndex
+//! @param [in]  stringBuffer
+//! @param [in]  stringBufferSize
+//-----------------------------------------------------------------------------
+void initializeStrIndex(string* strIndex, unsigned char* stringBuffer, size_t stringBufferSize)
+{
+    assert(strIndex != NULL);
+
+    strIndex[0].str      = stringBuffer;
+    size_t currentLine   = 1;
+    size_t lastLineStart = 0;
+
+    size_t i = 1;
+    for (; i < stringBufferSize - 1; i++)
+    {
+        if (stringBuffer[i - 1] == '\n' && stringBuffer[i] != '\n')
+        {
+            strIndex[currentLine].str = &stringBuffer[i];
+            strIndex[currentLine - 1].length = i - lastLineStart - 1;
+            lastLineStart = i;
+            currentLine++;
+        }
+    }
+
+    strIndex[currentLine - 1].length = i - lastLineStart - 1;
+}
+
+//-----------------------------------------------------------------------------
+//! Reads novel from file inputFileName, cleans it and builds the index of its
+//! lines.
+//!
+//! @param [in]   inputFileName
+//! @param [in]   codePage  encoding of the file
+//! @param [out]  novel
+//!
+//! @return 0 if there was no error and non-zero value otherwise.
+//-----------------------------------------------------------------------------
+int loadNovel(const char* inputFileName, CodePage codePage, Novel* novel)
+{
+    if (inputFileName == NULL || codePage >= CODE_PAGES_NUMBER || novel == NULL)
+        return -1;
+
+    struct stat inputFileStat = {};
+    if (stat(inputFileName, &inputFileStat) != 0)
+        return -1;
+    size_t inputFileSize = (size_t) inputFileStat.st_size;
+
+    File* inputFile = openFile(inputFileName, 'r');
+    if (inputFile == NULL)
+        return -1;
+
+    // 2 = possibly added '\n' + '\0'
+    unsigned char* inputFileBuffer = (unsigned char*) calloc(inputFileSize + 2, sizeof(unsigned char));
+    novel->buffer                  = (unsigned char*) calloc(inputFileSize + 2, sizeof(unsigned char));
+    if (inputFileBuffer == NULL || novel->buffer == NULL ||
+        readBufferFromFile(inputFile, sizeof(unsigned char), inputFileSize, inputFileBuffer) == FILE_END)
+    {
+        closeFile(inputFile);
+        free(inputFileBuffer);
+        destroyNovel(novel);
+        return -1;
+    }
+
+    closeFile(inputFile);
+
+    novel->codePage   = codePage;
+    novel->bufferSize = cleanNovel(inputFileBuffer, inputFileSize, novel->buffer, codePage);
+    free(inputFileBuffer);
+
+    novel->numberOfLines = 0;
+    for (size_t i = 0; i < novel->bufferSize; i++)
+        if (novel->buffer[i] == '\n')
+            novel->numberOfLines++;
+
+    novel->strIndex = (string*) calloc(novel->numberOfLines + 1, sizeof(string));
+    if (novel->strIndex == NULL)
+    {
+        destroyNovel(novel);
+        return -1;
+    }
+
+    if (novel->numberOfLines != 0)
+        initializeStrIndex(novel->strIndex, novel->buffer, novel->bufferSize);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Frees memory allocated by loadNovel.
+//!
+//! @param [out]  novel
+//-----------------------------------------------------------------------------
+void destroyNovel(Novel* novel)
+{
+    if (novel == NULL)
+        return;
+
+    free(novel->buffer);
+    free(novel->strIndex);
+
+    *novel = {};
+}
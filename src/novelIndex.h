@@ -0,0 +1,26 @@
+#pragma once
+
+#include "ioLib.h"
+#include "novelSort.h"
+
+constexpr size_t TITLE_MESSAGE_LENGTH = 100;
+
+//-----------------------------------------------------------------------------
+//! Cleaned novel in codePage and the index of its lines.
+//-----------------------------------------------------------------------------
+struct Novel
+{
+    unsigned char* buffer        = NULL;
+    size_t         bufferSize    = 0;
+    string*        strIndex      = NULL;
+    size_t         numberOfLines = 0;
+    CodePage       codePage      = DEFAULT_CODE_PAGE;
+};
+
+void writeTitleMessage      (File* outputFile, const char* message);
+void printStringBuffer      (File* outputFile, string* strIndex, size_t numberOfLines);
+int  printSortedStringBuffer(File* outputFile, string* strIndex, size_t numberOfLines,
+                             int (*compare)(const void* value1, const void* value2));
+void initializeStrIndex     (string* strIndex, unsigned char* stringBuffer, size_t stringBufferSize);
+int  loadNovel              (const char* inputFileName, CodePage codePage, Novel* novel);
+void destroyNovel           (Novel* novel);
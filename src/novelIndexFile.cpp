@@ -0,0 +1,657 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "novelClean.h"
+#include "novelIndex.h"
+#include "novelIndexFile.h"
+
+//-----------------------------------------------------------------------------
+//! Rounds value up to a multiple of 8.
+//-----------------------------------------------------------------------------
+static uint64_t alignOffset(uint64_t value)
+{
+    return (value + 7) & ~(uint64_t) 7;
+}
+
+//-----------------------------------------------------------------------------
+//! FNV-1a 64-bit hash of buffer.
+//!
+//! @param [in]  buffer
+//! @param [in]  size
+//!
+//! @return hash.
+//-----------------------------------------------------------------------------
+uint64_t hashBuffer(const unsigned char* buffer, size_t size)
+{
+    return hashBufferContinue(14695981039346656037ull, buffer, size);
+}
+
+//-----------------------------------------------------------------------------
+//! Continues FNV-1a 64-bit hash with buffer, so that hash of the whole data
+//! can be got from hash of its beginning.
+//!
+//! @param [in]  hash  hash of the data before buffer
+//! @param [in]  buffer
+//! @param [in]  size
+//!
+//! @return hash.
+//-----------------------------------------------------------------------------
+uint64_t hashBufferContinue(uint64_t hash, const unsigned char* buffer, size_t size)
+{
+    assert(buffer != NULL || size == 0);
+
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ buffer[i]) * 1099511628211ull;
+
+    return hash;
+}
+
+//-----------------------------------------------------------------------------
+//! Returns sourceFileName with INDEX_FILE_EXTENSION appended. The result has
+//! to be freed.
+//!
+//! @param [in]  sourceFileName
+//!
+//! @return index file name or NULL if there was an error.
+//-----------------------------------------------------------------------------
+char* getIndexFileName(const char* sourceFileName)
+{
+    if (sourceFileName == NULL)
+        return NULL;
+
+    size_t sourceLength    = strLength(sourceFileName);
+    size_t extensionLength = strLength(INDEX_FILE_EXTENSION);
+
+    char* indexFileName = (char*) calloc(sourceLength + extensionLength + 1, sizeof(char));
+    if (indexFileName == NULL)
+        return NULL;
+
+    memcpy(indexFileName,                sourceFileName,       sourceLength);
+    memcpy(indexFileName + sourceLength, INDEX_FILE_EXTENSION, extensionLength);
+
+    return indexFileName;
+}
+
+//-----------------------------------------------------------------------------
+//! Reads the whole file.
+//!
+//! @param [in]   fileName
+//! @param [out]  size
+//!
+//! @return buffer with the file's contents that has to be freed or NULL if
+//!         there was an error.
+//-----------------------------------------------------------------------------
+static unsigned char* readWholeFile(const char* fileName, size_t* size)
+{
+    assert(fileName != NULL);
+    assert(size     != NULL);
+
+    struct stat fileStat = {};
+    if (stat(fileName, &fileStat) != 0)
+        return NULL;
+    *size = (size_t) fileStat.st_size;
+
+    File* file = openFile(fileName, 'r');
+    if (file == NULL)
+        return NULL;
+
+    unsigned char* buffer = (unsigned char*) calloc(*size + 1, sizeof(unsigned char));
+    if (buffer != NULL && readBufferFromFile(file, sizeof(unsigned char), *size, buffer) == FILE_END)
+    {
+        free(buffer);
+        buffer = NULL;
+    }
+
+    closeFile(file);
+
+    return buffer;
+}
+
+//-----------------------------------------------------------------------------
+//! Finds number of the line starting at offset.
+//!
+//! @param [in]  lines  lines in order of their offsets
+//! @param [in]  numberOfLines
+//! @param [in]  offset
+//!
+//! @return number of the line.
+//-----------------------------------------------------------------------------
+static uint64_t findLineByOffset(const NovelIndexFileLine* lines, size_t numberOfLines, uint64_t offset)
+{
+    assert(lines != NULL);
+
+    size_t left  = 0;
+    size_t right = numberOfLines;
+    while (right - left > 1)
+    {
+        size_t mid = left + (right - left) / 2;
+        if (lines[mid].offset <= offset)
+            left = mid;
+        else
+            right = mid;
+    }
+
+    return left;
+}
+
+//-----------------------------------------------------------------------------
+//! Fills signature, version and offsets of the sections of header.
+//!
+//! @param [out]  header
+//! @param [in]   textSize
+//! @param [in]   numberOfLines
+//!
+//! @return size of the whole index file.
+//-----------------------------------------------------------------------------
+static size_t layoutNovelIndexFile(NovelIndexFileHeader* header, size_t textSize, size_t numberOfLines)
+{
+    assert(header != NULL);
+
+    memcpy(header->signature, INDEX_FILE_SIGNATURE, sizeof(header->signature));
+    header->version            = INDEX_FILE_VERSION;
+    header->textSize           = textSize;
+    header->numberOfLines      = numberOfLines;
+    header->textOffset         = alignOffset(sizeof(NovelIndexFileHeader));
+    header->linesOffset        = alignOffset(header->textOffset + textSize);
+    header->alphabeticalOffset = header->linesOffset        + numberOfLines * sizeof(NovelIndexFileLine);
+    header->reverseOffset      = header->alphabeticalOffset + numberOfLines * sizeof(uint64_t);
+
+    return (size_t) (header->reverseOffset + numberOfLines * sizeof(uint64_t));
+}
+
+//-----------------------------------------------------------------------------
+//! Sets pointers to the sections of indexFile.
+//!
+//! @param [out]  indexFile
+//-----------------------------------------------------------------------------
+static void attachNovelIndexFile(NovelIndexFile* indexFile)
+{
+    assert(indexFile       != NULL);
+    assert(indexFile->data != NULL);
+
+    indexFile->header            = (const NovelIndexFileHeader*) indexFile->data;
+    indexFile->text              = indexFile->data + indexFile->header->textOffset;
+    indexFile->lines             = (const NovelIndexFileLine*) (indexFile->data + indexFile->header->linesOffset);
+    indexFile->alphabeticalOrder = (const uint64_t*) (indexFile->data + indexFile->header->alphabeticalOffset);
+    indexFile->reverseOrder      = (const uint64_t*) (indexFile->data + indexFile->header->reverseOffset);
+}
+
+//-----------------------------------------------------------------------------
+//! Writes data of index file to file indexFileName.
+//!
+//! @param [in]  indexFileName
+//! @param [in]  data
+//! @param [in]  dataSize
+//!
+//! @return 0 if there was no error and non-zero value otherwise.
+//-----------------------------------------------------------------------------
+static int storeNovelIndexFile(const char* indexFileName, const unsigned char* data, size_t dataSize)
+{
+    assert(indexFileName != NULL);
+    assert(data          != NULL);
+
+    File* indexFile = openFile(indexFileName, 'w');
+    if (indexFile == NULL)
+        return -1;
+
+    writeBufferToFile(indexFile, sizeof(unsigned char), dataSize, data);
+    closeFile(indexFile);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Saves cleaned novel and its sorted orders to index file, so that output
+//! can be regenerated without cleaning and sorting while the source file
+//! stays the same.
+//!
+//! @param [in]  indexFileName
+//! @param [in]  sourceStat         stat of the source file
+//! @param [in]  source             contents of the source file
+//! @param [in]  sourceSize
+//! @param [in]  text               cleaned novel, lines end with '\n'
+//! @param [in]  textSize
+//! @param [in]  alphabeticalIndex  lines of text in alphabetical order
+//! @param [in]  reverseIndex       lines of text in reverse order
+//! @param [in]  numberOfLines
+//! @param [in]  codePage           encoding of the source file
+//!
+//! @return 0 if there was no error and non-zero value otherwise.
+//-----------------------------------------------------------------------------
+int saveNovelIndexFile(const char* indexFileName, const struct stat* sourceStat,
+                       const unsigned char* source, size_t sourceSize,
+                       const unsigned char* text, size_t textSize,
+                       const string* alphabeticalIndex, const string* reverseIndex,
+                       size_t numberOfLines, CodePage codePage)
+{
+    if (indexFileName == NULL || sourceStat == NULL || source == NULL || text == NULL ||
+        (numberOfLines != 0 && (alphabeticalIndex == NULL || reverseIndex == NULL)) ||
+        codePage >= CODE_PAGES_NUMBER)
+        return -1;
+
+    NovelIndexFileHeader header = {};
+    header.codePage         = codePage;
+    header.sourceSize       = sourceSize;
+    header.sourceModifyTime = (int64_t) sourceStat->st_mtime;
+    header.sourceHash       = hashBuffer(source, sourceSize);
+
+    size_t         dataSize = layoutNovelIndexFile(&header, textSize, numberOfLines);
+    unsigned char* data     = (unsigned char*) calloc(dataSize, sizeof(unsigned char));
+    if (data == NULL)
+        return -1;
+
+    memcpy(data, &header, sizeof(header));
+    memcpy(data + header.textOffset, text, textSize);
+
+    NovelIndexFileLine* lines             = (NovelIndexFileLine*) (data + header.linesOffset);
+    uint64_t*           alphabeticalOrder = (uint64_t*)           (data + header.alphabeticalOffset);
+    uint64_t*           reverseOrder      = (uint64_t*)           (data + header.reverseOffset);
+
+    size_t line      = 0;
+    size_t lineStart = 0;
+    for (size_t i = 0; i < textSize && line < numberOfLines; i++)
+    {
+        if (text[i] != '\n')
+            continue;
+
+        lines[line].offset = lineStart;
+        lines[line].length = i - lineStart;
+        line++;
+        lineStart = i + 1;
+    }
+
+    for (size_t i = 0; i < numberOfLines; i++)
+    {
+        alphabeticalOrder[i] = findLineByOffset(lines, numberOfLines, alphabeticalIndex[i].str - text);
+        reverseOrder[i]      = findLineByOffset(lines, numberOfLines, reverseIndex[i].str      - text);
+    }
+
+    int result = -1;
+    if (line == numberOfLines)
+        result = storeNovelIndexFile(indexFileName, data, dataSize);
+
+    free(data);
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//! Checks that sections of the index file lie inside of it and that lines
+//! and orders point inside of the text.
+//!
+//! @param [in]  indexFile
+//!
+//! @return 0 if the index file is correct and non-zero value otherwise.
+//-----------------------------------------------------------------------------
+static int verifyNovelIndexFile(const NovelIndexFile* indexFile)
+{
+    assert(indexFile != NULL);
+
+    const NovelIndexFileHeader* header = indexFile->header;
+    uint64_t numberOfLines = header->numberOfLines;
+
+    if (memcmp(header->signature, INDEX_FILE_SIGNATURE, sizeof(header->signature)) != 0 ||
+        header->version != INDEX_FILE_VERSION || header->codePage >= CODE_PAGES_NUMBER ||
+        numberOfLines > indexFile->dataSize / sizeof(uint64_t) ||
+        header->textOffset         % 8 != 0 || header->textOffset < sizeof(NovelIndexFileHeader) ||
+        header->linesOffset        % 8 != 0 || header->linesOffset < header->textOffset ||
+        header->textSize           > header->linesOffset - header->textOffset ||
+        header->alphabeticalOffset < header->linesOffset ||
+        header->alphabeticalOffset - header->linesOffset < numberOfLines * sizeof(NovelIndexFileLine) ||
+        header->reverseOffset      < header->alphabeticalOffset ||
+        header->reverseOffset - header->alphabeticalOffset < numberOfLines * sizeof(uint64_t) ||
+        header->reverseOffset      > indexFile->dataSize ||
+        indexFile->dataSize - header->reverseOffset < numberOfLines * sizeof(uint64_t))
+        return -1;
+
+    const NovelIndexFileLine* lines = (const NovelIndexFileLine*) (indexFile->data + header->linesOffset);
+    const uint64_t* alphabeticalOrder = (const uint64_t*) (indexFile->data + header->alphabeticalOffset);
+    const uint64_t* reverseOrder      = (const uint64_t*) (indexFile->data + header->reverseOffset);
+
+    for (size_t i = 0; i < numberOfLines; i++)
+    {
+        if (lines[i].offset > header->textSize || lines[i].length > header->textSize - lines[i].offset ||
+            alphabeticalOrder[i] >= numberOfLines || reverseOrder[i] >= numberOfLines)
+            return -1;
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Reads index file without checking whether it is up to date.
+//!
+//! @param [in]   indexFileName
+//! @param [out]  indexFile
+//!
+//! @return 0 if the index file has been read and non-zero value if it
+//!         doesn't exist or is broken.
+//-----------------------------------------------------------------------------
+static int readNovelIndexFile(const char* indexFileName, NovelIndexFile* indexFile)
+{
+    assert(indexFileName != NULL);
+    assert(indexFile     != NULL);
+
+    *indexFile = {};
+
+    indexFile->data = readWholeFile(indexFileName, &indexFile->dataSize);
+    if (indexFile->data == NULL)
+        return -1;
+
+    indexFile->header = (const NovelIndexFileHeader*) indexFile->data;
+    if (indexFile->dataSize < sizeof(NovelIndexFileHeader) || verifyNovelIndexFile(indexFile) != 0)
+    {
+        destroyNovelIndexFile(indexFile);
+        return -1;
+    }
+
+    attachNovelIndexFile(indexFile);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Loads index file if it is up to date with the source file. The index file
+//! is up to date if it has been made for the same code page and the source
+//! file has the same size and either the same modification time or the same
+//! hash.
+//!
+//! @param [in]   indexFileName
+//! @param [in]   sourceFileName
+//! @param [in]   codePage  encoding of the source file
+//! @param [out]  indexFile
+//!
+//! @return 0 if the index file has been loaded and non-zero value if it
+//!         doesn't exist, is out of date or is broken.
+//-----------------------------------------------------------------------------
+int loadNovelIndexFile(const char* indexFileName, const char* sourceFileName, CodePage codePage,
+                       NovelIndexFile* indexFile)
+{
+    if (indexFileName == NULL || sourceFileName == NULL || codePage >= CODE_PAGES_NUMBER || indexFile == NULL)
+        return -1;
+
+    *indexFile = {};
+
+    struct stat sourceStat = {};
+    if (stat(sourceFileName, &sourceStat) != 0 || readNovelIndexFile(indexFileName, indexFile) != 0)
+        return -1;
+
+    bool isUpToDate = indexFile->header->codePage   == (uint32_t) codePage &&
+                      indexFile->header->sourceSize == (uint64_t) sourceStat.st_size;
+    if (isUpToDate && indexFile->header->sourceModifyTime != (int64_t) sourceStat.st_mtime)
+    {
+        size_t         sourceSize = 0;
+        unsigned char* source     = readWholeFile(sourceFileName, &sourceSize);
+        isUpToDate = source != NULL && hashBuffer(source, sourceSize) == indexFile->header->sourceHash;
+        free(source);
+    }
+
+    if (!isUpToDate)
+    {
+        destroyNovelIndexFile(indexFile);
+        return -1;
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Merges order of the lines already in the index file with sorted new lines.
+//!
+//! @param [out]  mergedOrder
+//! @param [in]   text          text of the updated index file
+//! @param [in]   lines         lines of the updated index file
+//! @param [in]   oldOrder
+//! @param [in]   oldNumberOfLines
+//! @param [in]   newLines      sorted new lines
+//! @param [in]   newNumberOfLines
+//! @param [in]   compare
+//-----------------------------------------------------------------------------
+static void mergeIndexFileOrders(uint64_t* mergedOrder, const unsigned char* text, const NovelIndexFileLine* lines,
+                                 const uint64_t* oldOrder, size_t oldNumberOfLines,
+                                 const string* newLines, size_t newNumberOfLines,
+                                 int (*compare)(const void* str1, const void* str2))
+{
+    assert(mergedOrder != NULL);
+    assert(text        != NULL);
+    assert(lines       != NULL);
+    assert(compare     != NULL);
+
+    size_t oldLine = 0;
+    size_t newLine = 0;
+    while (oldLine < oldNumberOfLines || newLine < newNumberOfLines)
+    {
+        bool takeOld = newLine == newNumberOfLines;
+        if (oldLine < oldNumberOfLines && !takeOld)
+        {
+            const NovelIndexFileLine* line = &lines[oldOrder[oldLine]];
+            string oldString = { (unsigned char*) text + line->offset, (size_t) line->length };
+            takeOld = compare(&oldString, &newLines[newLine]) <= 0;
+        }
+
+        if (takeOld)
+            *(mergedOrder++) = oldOrder[oldLine++];
+        else
+            *(mergedOrder++) = oldNumberOfLines + findLineByOffset(lines + oldNumberOfLines, newNumberOfLines, 
+                                                                   newLines[newLine++].str - text);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Updates index file after text has been appended to the source file: only
+//! the appended part is cleaned and sorted, then the new lines are merged
+//! into the sorted orders of the index file. Takes O(old + new) for merging
+//! and O(new log new) for sorting the new lines.
+//!
+//! @param [in]   indexFileName
+//! @param [in]   sourceFileName
+//! @param [in]   codePage   encoding of the source file
+//! @param [out]  indexFile  updated index file
+//!
+//! @return 0 if the index file has been updated and non-zero value if it
+//!         can't be updated (e.g. the source file has been changed not only
+//!         by appending text to it, the index file has been made for another
+//!         code page or it can't be stored). indexFile is left empty on error.
+//-----------------------------------------------------------------------------
+int updateNovelIndexFile(const char* indexFileName, const char* sourceFileName, CodePage codePage,
+                         NovelIndexFile* indexFile)
+{
+    if (indexFileName == NULL || sourceFileName == NULL || codePage >= CODE_PAGES_NUMBER || indexFile == NULL)
+        return -1;
+
+    *indexFile = {};
+
+    struct stat    sourceStat   = {};
+    NovelIndexFile oldIndexFile = {};
+    if (stat(sourceFileName, &sourceStat) != 0 || readNovelIndexFile(indexFileName, &oldIndexFile) != 0)
+        return -1;
+
+    const NovelIndexFileHeader* oldHeader   = oldIndexFile.header;
+    const StrComparators*       comparators = getStrComparators(codePage);
+    if (oldHeader->codePage != (uint32_t) codePage)
+    {
+        destroyNovelIndexFile(&oldIndexFile);
+        return -1;
+    }
+
+    size_t oldSourceSize    = (size_t) oldHeader->sourceSize;
+    size_t oldTextSize      = (size_t) oldHeader->textSize;
+    size_t oldNumberOfLines = (size_t) oldHeader->numberOfLines;
+
+    // the old part of the source must stay the same and end with a whole line
+    size_t         sourceSize = 0;
+    unsigned char* source     = NULL;
+    uint64_t       oldHash    = 0;
+    if ((uint64_t) sourceStat.st_size <= oldSourceSize ||
+        (source = readWholeFile(sourceFileName, &sourceSize)) == NULL ||
+        sourceSize <= oldSourceSize ||
+        (oldSourceSize != 0 && source[oldSourceSize - 1] != '\n') ||
+        (oldHash = hashBuffer(source, oldSourceSize)) != oldHeader->sourceHash)
+    {
+        free(source);
+        destroyNovelIndexFile(&oldIndexFile);
+        return -1;
+    }
+
+    // cleaning, indexing and sorting only the appended part
+    size_t         appendedSize = sourceSize - oldSourceSize;
+    unsigned char* appendedText = (unsigned char*) calloc(appendedSize + 2, sizeof(unsigned char));
+    size_t         appendedTextSize = 0;
+    size_t         newNumberOfLines = 0;
+    if (appendedText != NULL)
+    {
+        appendedTextSize = cleanNovelChunk(source + oldSourceSize, appendedSize, appendedText, codePage);
+        for (size_t i = 0; i < appendedTextSize; i++)
+            if (appendedText[i] == '\n')
+                newNumberOfLines++;
+    }
+
+    NovelIndexFileHeader header = *oldHeader;
+    header.sourceSize       = sourceSize;
+    header.sourceModifyTime = (int64_t) sourceStat.st_mtime;
+    header.sourceHash       = hashBufferContinue(oldHash, source + oldSourceSize, appendedSize);
+    free(source);
+
+    size_t         dataSize          = layoutNovelIndexFile(&header, oldTextSize + appendedTextSize, 
+                                                            oldNumberOfLines + newNumberOfLines);
+    unsigned char* data              = (unsigned char*) calloc(dataSize, sizeof(unsigned char));
+    string*        alphabeticalIndex = (string*) calloc(newNumberOfLines + 1, sizeof(string));
+    string*        reverseIndex      = (string*) calloc(newNumberOfLines + 1, sizeof(string));
+    if (appendedText == NULL || data == NULL || alphabeticalIndex == NULL || reverseIndex == NULL)
+    {
+        free(appendedText);
+        free(data);
+        free(alphabeticalIndex);
+        free(reverseIndex);
+        destroyNovelIndexFile(&oldIndexFile);
+        return -1;
+    }
+
+    memcpy(data, &header, sizeof(header));
+
+    unsigned char*      text  = data + header.textOffset;
+    NovelIndexFileLine* lines = (NovelIndexFileLine*) (data + header.linesOffset);
+    memcpy(text,               oldIndexFile.text,  oldTextSize);
+    memcpy(text + oldTextSize, appendedText,       appendedTextSize);
+    memcpy(lines,              oldIndexFile.lines, oldNumberOfLines * sizeof(NovelIndexFileLine));
+    free(appendedText);
+
+    size_t line      = oldNumberOfLines;
+    size_t lineStart = oldTextSize;
+    for (size_t i = oldTextSize; i < oldTextSize + appendedTextSize; i++)
+    {
+        if (text[i] != '\n')
+            continue;
+
+        lines[line].offset = lineStart;
+        lines[line].length = i - lineStart;
+
+        alphabeticalIndex[line - oldNumberOfLines] = string{ text + lineStart, i - lineStart };
+        reverseIndex     [line - oldNumberOfLines] = string{ text + lineStart, i - lineStart };
+
+        line++;
+        lineStart = i + 1;
+    }
+
+    sortStrIndex(alphabeticalIndex, newNumberOfLines, comparators->alphabetically, 0);
+    sortStrIndex(reverseIndex,      newNumberOfLines, comparators->reversely,      1);
+
+    mergeIndexFileOrders((uint64_t*) (data + header.alphabeticalOffset), text, lines,
+                         oldIndexFile.alphabeticalOrder, oldNumberOfLines,
+                         alphabeticalIndex, newNumberOfLines, comparators->alphabetically);
+    mergeIndexFileOrders((uint64_t*) (data + header.reverseOffset),      text, lines,
+                         oldIndexFile.reverseOrder,      oldNumberOfLines,
+                         reverseIndex,      newNumberOfLines, comparators->reversely);
+
+    free(alphabeticalIndex);
+    free(reverseIndex);
+    destroyNovelIndexFile(&oldIndexFile);
+
+    indexFile->data     = data;
+    indexFile->dataSize = dataSize;
+    attachNovelIndexFile(indexFile);
+
+    if (storeNovelIndexFile(indexFileName, data, dataSize) != 0)
+    {
+        destroyNovelIndexFile(indexFile);
+        return -1;
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Prints lines of indexFile in order to outputFile.
+//!
+//! @param [out]  outputFile
+//! @param [in]   indexFile
+//! @param [in]   order
+//-----------------------------------------------------------------------------
+static void printIndexFileOrder(File* outputFile, const NovelIndexFile* indexFile, const uint64_t* order)
+{
+    assert(outputFile != NULL);
+    assert(indexFile  != NULL);
+    assert(order      != NULL);
+
+    for (size_t i = 0; i < indexFile->header->numberOfLines; i++)
+    {
+        const NovelIndexFileLine* line = &indexFile->lines[order[i]];
+        writeBufferToFile(outputFile, sizeof(unsigned char), (size_t) line->length, indexFile->text + line->offset);
+        writeChar(outputFile, '\n');
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Writes the same output as runNovelPipeline does, but takes everything
+//! from indexFile. If originalFileName isn't NULL, the original novel is read
+//! from it and written first.
+//!
+//! @param [out]  outputFile
+//! @param [in]   indexFile
+//! @param [in]   originalFileName
+//!
+//! @return 0 if there was no error and non-zero value otherwise.
+//-----------------------------------------------------------------------------
+int writeNovelFromIndexFile(File* outputFile, const NovelIndexFile* indexFile, const char* originalFileName)
+{
+    if (outputFile == NULL || indexFile == NULL || indexFile->header == NULL)
+        return -1;
+
+    if (originalFileName != NULL)
+    {
+        size_t         originalSize = 0;
+        unsigned char* original     = readWholeFile(originalFileName, &originalSize);
+        if (original == NULL)
+            return -1;
+
+        writeTitleMessage(outputFile, "Original novel");
+        writeBufferToFile(outputFile, sizeof(unsigned char), originalSize, original);
+        free(original);
+    }
+
+    writeTitleMessage(outputFile, "Cleaned novel");
+    writeBufferToFile(outputFile, sizeof(unsigned char), (size_t) indexFile->header->textSize, indexFile->text);
+
+    writeTitleMessage  (outputFile, "Alphabetically sorted novel");
+    printIndexFileOrder(outputFile, indexFile, indexFile->alphabeticalOrder);
+
+    writeTitleMessage  (outputFile, "Reversely sorted novel");
+    printIndexFileOrder(outputFile, indexFile, indexFile->reverseOrder);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Frees memory allocated by loadNovelIndexFile.
+//!
+//! @param [out]  indexFile
+//-----------------------------------------------------------------------------
+void destroyNovelIndexFile(NovelIndexFile* indexFile)
+{
+    if (indexFile == NULL)
+        return;
+
+    free(indexFile->data);
+    *indexFile = {};
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdint.h>
+#include <sys/stat.h>
+
+#include "ioLib.h"
+#include "novelSort.h"
+
+constexpr const char* INDEX_FILE_EXTENSION = ".idx";
+constexpr const char  INDEX_FILE_SIGNATURE[8] = { 'O', 'N', 'E', 'G', 'I', 'D', 'X', '\0' };
+constexpr uint32_t    INDEX_FILE_VERSION      = 3;
+
+//-----------------------------------------------------------------------------
+//! Index file consists of the header and four sections each starting at an
+//! offset divisible by 8:
+//!   text               - cleaned novel (lines separated by '\n')
+//!   lines              - NovelIndexFileLine for each line in cleaned order
+//!   alphabeticalOrder  - uint64_t numbers of lines in alphabetical order
+//!   reverseOrder       - uint64_t numbers of lines in reverse order
+//! All of the sections are used right from the file's buffer. codePage is
+//! the encoding of the source file the orders have been sorted in.
+//-----------------------------------------------------------------------------
+struct NovelIndexFileHeader
+{
+    char     signature[8]       = {};
+    uint32_t version            = 0;
+    uint32_t codePage           = 0;
+
+    uint64_t sourceSize         = 0;
+    int64_t  sourceModifyTime   = 0;
+    uint64_t sourceHash         = 0;
+
+    uint64_t textSize           = 0;
+    uint64_t numberOfLines      = 0;
+
+    uint64_t textOffset         = 0;
+    uint64_t linesOffset        = 0;
+    uint64_t alphabeticalOffset = 0;
+    uint64_t reverseOffset      = 0;
+};
+
+struct NovelIndexFileLine
+{
+    uint64_t offset = 0;
+    uint64_t length = 0;
+};
+
+struct NovelIndexFile
+{
+    unsigned char*              data              = NULL;
+    size_t                      dataSize          = 0;
+
+    const NovelIndexFileHeader* header            = NULL;
+    const unsigned char*        text              = NULL;
+    const NovelIndexFileLine*   lines             = NULL;
+    const uint64_t*             alphabeticalOrder = NULL;
+    const uint64_t*             reverseOrder      = NULL;
+};
+
+uint64_t hashBuffer              (const unsigned char* buffer, size_t size);
+uint64_t hashBufferContinue      (uint64_t hash, const unsigned char* buffer, size_t size);
+char*    getIndexFileName        (const char* sourceFileName);
+int      saveNovelIndexFile      (const char* indexFileName, const struct stat* sourceStat,
+                                  const unsigned char* source, size_t sourceSize,
+                                  const unsigned char* text, size_t textSize,
+                                  const string* alphabeticalIndex, const string* reverseIndex,
+                                  size_t numberOfLines, CodePage codePage);
+int      loadNovelIndexFile      (const char* indexFileName, const char* sourceFileName, CodePage codePage,
+                                  NovelIndexFile* indexFile);
+int      updateNovelIndexFile    (const char* indexFileName, const char* sourceFileName, CodePage codePage,
+                                  NovelIndexFile* indexFile);
+int      writeNovelFromIndexFile (File* outputFile, const NovelIndexFile* indexFile, const char* originalFileName);
+void     destroyNovelIndexFile   (NovelIndexFile* indexFile);
@@ -0,0 +1,410 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <sys/stat.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "novelClean.h"
+#include "novelSort.h"
+#include "novelIndex.h"
+#include "novelIndexFile.h"
+#include "novelPipeline.h"
+
+//-----------------------------------------------------------------------------
+//! Progress of a pipeline stage. Every stage writes its result into a buffer
+//! allocated beforehand and advances its cursor, the next stages wait for the
+//! cursor and process everything before it.
+//-----------------------------------------------------------------------------
+struct StageCursor
+{
+    std::mutex              mutex;
+    std::condition_variable advanced;
+    size_t                  position = 0;
+    bool                    finished = false;
+};
+
+struct NovelPipeline
+{
+    File*                 inputFile         = NULL;
+    File*                 outputFile        = NULL;
+    bool                  printOriginal     = 0;
+    bool                  removeDuplicates  = 0;
+    CodePage              codePage          = DEFAULT_CODE_PAGE;
+    const StrComparators* comparators       = NULL;
+
+    unsigned char*        inputBuffer       = NULL;
+    size_t                inputFileSize     = 0;
+    unsigned char*        cleanBuffer       = NULL;
+
+    string*               alphabeticalIndex = NULL;
+    string*               reverseIndex      = NULL;
+    size_t                numberOfLines     = 0;
+    int                   writeResult       = 0;
+
+    StageCursor           read;
+    StageCursor           cleaned;
+    StageCursor           indexed;
+    StageCursor           reverselySorted;
+};
+
+//-----------------------------------------------------------------------------
+//! Moves cursor to position and wakes up stages waiting for it.
+//!
+//! @param [out]  cursor
+//! @param [in]   position
+//-----------------------------------------------------------------------------
+static void cursorAdvance(StageCursor* cursor, size_t position)
+{
+    assert(cursor != NULL);
+
+    {
+        std::lock_guard<std::mutex> lock(cursor->mutex);
+        cursor->position = position;
+    }
+
+    cursor->advanced.notify_all();
+}
+
+//-----------------------------------------------------------------------------
+//! Marks that cursor won't be moved anymore.
+//!
+//! @param [out]  cursor
+//-----------------------------------------------------------------------------
+static void cursorFinish(StageCursor* cursor)
+{
+    assert(cursor != NULL);
+
+    {
+        std::lock_guard<std::mutex> lock(cursor->mutex);
+        cursor->finished = 1;
+    }
+
+    cursor->advanced.notify_all();
+}
+
+//-----------------------------------------------------------------------------
+//! Waits until cursor is moved further than position or is finished.
+//!
+//! @param [in]   cursor
+//! @param [in]   position
+//! @param [out]  finished
+//!
+//! @return current position of the cursor.
+//-----------------------------------------------------------------------------
+static size_t cursorWait(StageCursor* cursor, size_t position, bool* finished)
+{
+    assert(cursor   != NULL);
+    assert(finished != NULL);
+
+    std::unique_lock<std::mutex> lock(cursor->mutex);
+    cursor->advanced.wait(lock, [cursor, position] { return cursor->position > position || cursor->finished; });
+
+    *finished = cursor->finished;
+    return cursor->position;
+}
+
+//-----------------------------------------------------------------------------
+//! Reads input file block by block. If the last line has no '\n', adds it.
+//!
+//! @param [out]  pipeline
+//-----------------------------------------------------------------------------
+static void readStage(NovelPipeline* pipeline)
+{
+    assert(pipeline != NULL);
+
+    size_t bytesRead = 0;
+    while (bytesRead < pipeline->inputFileSize)
+    {
+        size_t blockSize = pipeline->inputFileSize - bytesRead;
+        if (blockSize > PIPELINE_READ_BLOCK_SIZE)
+            blockSize = PIPELINE_READ_BLOCK_SIZE;
+
+        if (readBufferFromFile(pipeline->inputFile, sizeof(unsigned char), blockSize,
+                               pipeline->inputBuffer + bytesRead) == FILE_END)
+            break;
+
+        bytesRead += blockSize;
+        if (bytesRead < pipeline->inputFileSize)
+            cursorAdvance(&pipeline->read, bytesRead);
+    }
+
+    if (bytesRead != 0 && pipeline->inputBuffer[bytesRead - 1] != '\n')
+        pipeline->inputBuffer[bytesRead++] = '\n';
+
+    cursorAdvance(&pipeline->read, bytesRead);
+    cursorFinish (&pipeline->read);
+}
+
+//-----------------------------------------------------------------------------
+//! Cleans lines as soon as they are read. A line is cleaned only when all the
+//! symbols cleanNovelChunk may look at (MAX_LINE_LENGTH from its start) have
+//! already been read.
+//!
+//! @param [out]  pipeline
+//-----------------------------------------------------------------------------
+static void cleanStage(NovelPipeline* pipeline)
+{
+    assert(pipeline != NULL);
+
+    size_t consumed = 0;
+    size_t produced = 0;
+    size_t waitFor  = 0;
+    bool   finished = 0;
+    while (!finished)
+    {
+        size_t available = cursorWait(&pipeline->read, waitFor, &finished);
+        size_t chunkEnd  = available;
+
+        if (!finished)
+        {
+            size_t safeEnd = available > consumed + MAX_LINE_LENGTH ? available - MAX_LINE_LENGTH : consumed;
+            for (chunkEnd = safeEnd; chunkEnd > consumed && pipeline->inputBuffer[chunkEnd - 1] != '\n'; chunkEnd--);
+        }
+
+        if (chunkEnd > consumed)
+        {
+            produced += cleanNovelChunk(pipeline->inputBuffer + consumed, chunkEnd - consumed,
+                                        pipeline->cleanBuffer + produced, pipeline->codePage);
+            consumed  = chunkEnd;
+            cursorAdvance(&pipeline->cleaned, produced);
+        }
+
+        waitFor = available;
+    }
+
+    cursorFinish(&pipeline->cleaned);
+}
+
+//-----------------------------------------------------------------------------
+//! Sorts reverse index of the pipeline.
+//!
+//! @param [out]  pipeline
+//-----------------------------------------------------------------------------
+static void sortReverselyStage(NovelPipeline* pipeline)
+{
+    assert(pipeline != NULL);
+
+    sortStrIndex(pipeline->reverseIndex, pipeline->numberOfLines, pipeline->comparators->reversely, 1);
+
+    cursorFinish(&pipeline->reverselySorted);
+}
+
+//-----------------------------------------------------------------------------
+//! Writes everything behind cursor from buffer to outputFile until the cursor
+//! is finished.
+//!
+//! @param [out]  outputFile
+//! @param [in]   cursor
+//! @param [in]   buffer
+//! @param [in]   limit  the maximum number of bytes to write
+//-----------------------------------------------------------------------------
+static void streamBuffer(File* outputFile, StageCursor* cursor, const unsigned char* buffer, size_t limit)
+{
+    assert(outputFile != NULL);
+    assert(cursor     != NULL);
+    assert(buffer     != NULL);
+
+    size_t written  = 0;
+    bool   finished = 0;
+    while (!finished)
+    {
+        size_t available = cursorWait(cursor, written, &finished);
+        if (available > limit)
+            available = limit;
+
+        if (available > written)
+        {
+            writeBufferToFile(outputFile, sizeof(unsigned char), available - written, buffer + written);
+            written = available;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Writes each section of the output as soon as it is ready. Alphabetically
+//! sorted section is streamed while it's being sorted. Sets
+//! pipeline->writeResult if it can't be sorted.
+//!
+//! @param [out]  pipeline
+//-----------------------------------------------------------------------------
+static void writeStage(NovelPipeline* pipeline)
+{
+    assert(pipeline != NULL);
+
+    bool finished = 0;
+
+    if (pipeline->printOriginal)
+    {
+        writeTitleMessage(pipeline->outputFile, "Original novel");
+        streamBuffer(pipeline->outputFile, &pipeline->read, pipeline->inputBuffer, pipeline->inputFileSize);
+    }
+
+    writeTitleMessage(pipeline->outputFile, "Cleaned novel");
+    streamBuffer(pipeline->outputFile, &pipeline->cleaned, pipeline->cleanBuffer, pipeline->inputFileSize + 1);
+
+    // alphabetical order is sorted lazily while being written
+    cursorWait(&pipeline->indexed, 0, &finished);
+    writeTitleMessage(pipeline->outputFile, "Alphabetically sorted novel");
+    if (pipeline->numberOfLines != 0)
+        pipeline->writeResult = printSortedStringBuffer(pipeline->outputFile, pipeline->alphabeticalIndex,
+                                                        pipeline->numberOfLines, pipeline->comparators->alphabetically);
+
+    cursorWait(&pipeline->reverselySorted, 0, &finished);
+    writeTitleMessage(pipeline->outputFile, "Reversely sorted novel");
+    if (pipeline->numberOfLines != 0)
+        printStringBuffer(pipeline->outputFile, pipeline->reverseIndex, pipeline->numberOfLines);
+}
+
+//-----------------------------------------------------------------------------
+//! Builds the index of cleaned lines as soon as they are cleaned, removes
+//! duplicates from it if pipeline->removeDuplicates is set (see
+//! removeDuplicates), then hands a copy of it to the writer, which sorts it
+//! alphabetically, and sorts the other copy reversely at the same time.
+//!
+//! @param [out]  pipeline
+//!
+//! @return 0 if there was no error and non-zero value otherwise.
+//-----------------------------------------------------------------------------
+static int indexAndSort(NovelPipeline* pipeline)
+{
+    assert(pipeline != NULL);
+
+    size_t  capacity  = 0;
+    string* strIndex  = NULL;
+    size_t  lineStart = 0;
+    size_t  indexed   = 0;
+    bool    finished  = 0;
+    while (!finished)
+    {
+        size_t available = cursorWait(&pipeline->cleaned, indexed, &finished);
+
+        for (; indexed < available; indexed++)
+        {
+            if (pipeline->cleanBuffer[indexed] != '\n')
+                continue;
+
+            string line = { pipeline->cleanBuffer + lineStart, indexed - lineStart };
+            lineStart   = indexed + 1;
+
+            if (pipeline->numberOfLines == capacity)
+            {
+                capacity = capacity == 0 ? PIPELINE_READ_BLOCK_SIZE / 16 : capacity * 2;
+                string* newIndex = (string*) realloc(strIndex, capacity * sizeof(string));
+                if (newIndex == NULL)
+                {
+                    free(strIndex);
+                    return -1;
+                }
+
+                strIndex = newIndex;
+            }
+
+            strIndex[pipeline->numberOfLines++] = line;
+        }
+    }
+
+    if (pipeline->removeDuplicates &&
+        removeDuplicates(strIndex, &pipeline->numberOfLines, NULL, pipeline->codePage) != 0)
+    {
+        free(strIndex);
+        return -1;
+    }
+
+    pipeline->alphabeticalIndex = strIndex;
+    pipeline->reverseIndex      = (string*) calloc(pipeline->numberOfLines + 1, sizeof(string));
+    if (pipeline->reverseIndex == NULL)
+        return -1;
+
+    if (pipeline->numberOfLines != 0)
+        memcpy(pipeline->reverseIndex, strIndex, pipeline->numberOfLines * sizeof(string));
+
+    cursorFinish(&pipeline->indexed);
+    sortReverselyStage(pipeline);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Generates the same output as the sequential read -> clean -> index -> sort
+//! -> write, but runs the stages at the same time: lines are cleaned and
+//! indexed while the file is being read, the cleaned novel is written while
+//! it is being cleaned, the alphabetical order is written while it's being
+//! sorted and the reverse one is sorted meanwhile. If options->indexFileName
+//! isn't NULL and there was no error, saves the results to index file (see
+//! saveNovelIndexFile).
+//!
+//! @param [in]   inputFileName
+//! @param [out]  outputFile
+//! @param [in]   options
+//!
+//! @return 0 if there was no error and non-zero value otherwise.
+//-----------------------------------------------------------------------------
+int runNovelPipeline(const char* inputFileName, File* outputFile, const PipelineOptions* options)
+{
+    if (inputFileName == NULL || outputFile == NULL || options == NULL || options->codePage >= CODE_PAGES_NUMBER)
+        return -1;
+
+    struct stat inputFileStat = {};
+    if (stat(inputFileName, &inputFileStat) != 0)
+        return -1;
+
+    NovelPipeline pipeline;
+    pipeline.outputFile       = outputFile;
+    pipeline.printOriginal    = options->printOriginal;
+    pipeline.removeDuplicates = options->removeDuplicates;
+    pipeline.codePage         = options->codePage;
+    pipeline.comparators      = getStrComparators(options->codePage);
+    pipeline.inputFileSize    = (size_t) inputFileStat.st_size;
+    pipeline.inputFile        = openFile(inputFileName, 'r');
+    if (pipeline.inputFile == NULL)
+        return -1;
+
+    // 2 = possibly added '\n' + '\0'
+    pipeline.inputBuffer = (unsigned char*) calloc(pipeline.inputFileSize + 2, sizeof(unsigned char));
+    pipeline.cleanBuffer = (unsigned char*) calloc(pipeline.inputFileSize + 2, sizeof(unsigned char));
+    if (pipeline.inputBuffer == NULL || pipeline.cleanBuffer == NULL)
+    {
+        free(pipeline.inputBuffer);
+        free(pipeline.cleanBuffer);
+        closeFile(pipeline.inputFile);
+        return -1;
+    }
+
+    std::thread reader (readStage,  &pipeline);
+    std::thread cleaner(cleanStage, &pipeline);
+    std::thread writer (writeStage, &pipeline);
+
+    int result = indexAndSort(&pipeline);
+    if (result != 0)
+    {
+        // let the writer finish with empty sections
+        pipeline.numberOfLines = 0;
+        cursorFinish(&pipeline.indexed);
+        cursorFinish(&pipeline.reverselySorted);
+    }
+
+    reader.join();
+    cleaner.join();
+    writer.join();
+
+    closeFile(pipeline.inputFile);
+
+    if (result == 0)
+        result = pipeline.writeResult;
+
+    if (result == 0 && options->indexFileName != NULL)
+        result = saveNovelIndexFile(options->indexFileName, &inputFileStat,
+                                    pipeline.inputBuffer, pipeline.inputFileSize,
+                                    pipeline.cleanBuffer, pipeline.cleaned.position,
+                                    pipeline.alphabeticalIndex, pipeline.reverseIndex,
+                                    pipeline.numberOfLines, pipeline.codePage);
+
+    free(pipeline.inputBuffer);
+    free(pipeline.cleanBuffer);
+    free(pipeline.alphabeticalIndex);
+    free(pipeline.reverseIndex);
+
+    return result;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "ioLib.h"
+#include "codePage.h"
+
+constexpr size_t PIPELINE_READ_BLOCK_SIZE = 64 * 1024;
+
+//-----------------------------------------------------------------------------
+//! printOriginal    - write the original novel before the cleaned one
+//! removeDuplicates - sort and write only the first of equal lines
+//! indexFileName    - where to save index file, NULL not to save it
+//! codePage         - encoding of the input file
+//-----------------------------------------------------------------------------
+struct PipelineOptions
+{
+    bool        printOriginal    = 0;
+    bool        removeDuplicates = 0;
+    const char* indexFileName    = NULL;
+    CodePage    codePage         = DEFAULT_CODE_PAGE;
+};
+
+int runNovelPipeline(const char* inputFileName, File* outputFile, const PipelineOptions* options);
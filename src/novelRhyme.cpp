@@ -0,0 +1,444 @@
+#include <stdlib.h>
+#include <assert.h>
+
+#include "novelRhyme.h"
+
+//-----------------------------------------------------------------------------
+//! Line of the index along with its number. line is the first member, so
+//! that string comparators can sort them.
+//-----------------------------------------------------------------------------
+struct RhymeIndexLine
+{
+    string line   = {};
+    size_t number = 0;
+};
+
+//-----------------------------------------------------------------------------
+//! Gets normalized ending of the string in codePage (see RhymeEnding).
+//!
+//! @param [in]   str
+//! @param [in]   length
+//! @param [out]  ending
+//!
+//! @return length of the ending, which is less than RHYME_ENDING_LENGTH only
+//!         if there are not enough letters in the string.
+//-----------------------------------------------------------------------------
+template <CodePage codePage>
+size_t getRhymeEnding(const unsigned char* str, size_t length, RhymeEnding* ending)
+{
+    assert(str    != NULL || length == 0);
+    assert(ending != NULL);
+
+    *ending = {};
+
+    const unsigned char* ptr = str + length;
+    while (ptr != str && ending->length < RHYME_ENDING_LENGTH)
+    {
+        ptr--;
+
+        if (collationWeight<codePage>(*ptr) == 0)
+            continue;
+
+        ending->symbols[ending->length++] = lowerCaseSymbol<codePage>(*ptr);
+    }
+
+    return ending->length;
+}
+
+template size_t getRhymeEnding<CODE_PAGE_CP1251>    (const unsigned char* str, size_t length, RhymeEnding* ending);
+template size_t getRhymeEnding<CODE_PAGE_KOI8_R>    (const unsigned char* str, size_t length, RhymeEnding* ending);
+template size_t getRhymeEnding<CODE_PAGE_ISO_8859_5>(const unsigned char* str, size_t length, RhymeEnding* ending);
+
+// in the order of CodePage
+static size_t (* const RHYME_ENDING_GETTERS[CODE_PAGES_NUMBER])(const unsigned char* str, size_t length,
+                                                                RhymeEnding* ending) =
+    { getRhymeEnding<CODE_PAGE_CP1251>, getRhymeEnding<CODE_PAGE_KOI8_R>, getRhymeEnding<CODE_PAGE_ISO_8859_5> };
+
+//-----------------------------------------------------------------------------
+//! FNV-1a hash of the first length symbols of ending.
+//!
+//! @param [in]  ending
+//! @param [in]  length
+//!
+//! @return hash.
+//-----------------------------------------------------------------------------
+static size_t hashRhymeEnding(const RhymeEnding* ending, size_t length)
+{
+    assert(ending != NULL);
+
+    size_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++)
+        hash = (hash ^ ending->symbols[i]) * 16777619u;
+
+    return (hash ^ length) * 16777619u;
+}
+
+//-----------------------------------------------------------------------------
+//! Looks for the group of lines ending with the first length symbols of
+//! ending.
+//!
+//! @param [in]  groups
+//! @param [in]  groupsCapacity  power of 2
+//! @param [in]  ending
+//! @param [in]  length
+//! @param [in]  hash
+//!
+//! @return the group or the empty slot of the table where it should be.
+//-----------------------------------------------------------------------------
+static RhymeGroup* findRhymeGroup(RhymeGroup* groups, size_t groupsCapacity,
+                                  const RhymeEnding* ending, size_t length, size_t hash)
+{
+    assert(groups != NULL);
+    assert(ending != NULL);
+
+    size_t slot = hash & (groupsCapacity - 1);
+    while (true)
+    {
+        RhymeGroup* group = &groups[slot];
+        if (group->ending.length == 0)
+            return group;
+
+        if (group->hash == hash && group->ending.length == length)
+        {
+            size_t i = 0;
+            for (; i < length && group->ending.symbols[i] == ending->symbols[i]; i++);
+
+            if (i == length)
+                return group;
+        }
+
+        slot = (slot + 1) & (groupsCapacity - 1);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Doubles capacity of the groups table.
+//!
+//! @param [out]  index
+//!
+//! @return 0 if there was no error and non-zero value otherwise.
+//-----------------------------------------------------------------------------
+static int growRhymeGroups(RhymeIndex* index)
+{
+    assert(index != NULL);
+
+    size_t      newCapacity = index->groupsCapacity * 2;
+    RhymeGroup* newGroups   = (RhymeGroup*) calloc(newCapacity, sizeof(RhymeGroup));
+    if (newGroups == NULL)
+        return -1;
+
+    for (size_t i = 0; i < index->groupsCapacity; i++)
+    {
+        RhymeGroup* group = &index->groups[i];
+        if (group->ending.length == 0)
+            continue;
+
+        *findRhymeGroup(newGroups, newCapacity, &group->ending, group->ending.length, group->hash) = *group;
+    }
+
+    free(index->groups);
+    index->groups         = newGroups;
+    index->groupsCapacity = newCapacity;
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Builds rhyme index of lines from strIndex, which has to live as long as
+//! the index does. Lines of every group are in reverse order (see
+//! findRhymes). Takes O(numberOfLines * RHYME_ENDING_LENGTH) and
+//! O(numberOfLines * log(numberOfLines)) for sorting the lines reversely.
+//!
+//! @param [out]  index
+//! @param [in]   strIndex
+//! @param [in]   numberOfLines
+//! @param [in]   codePage  encoding of the lines
+//!
+//! @return 0 if there was no error and non-zero value otherwise.
+//-----------------------------------------------------------------------------
+int buildRhymeIndex(RhymeIndex* index, string* strIndex, size_t numberOfLines, CodePage codePage)
+{
+    if (index == NULL || (strIndex == NULL && numberOfLines != 0) || codePage >= CODE_PAGES_NUMBER)
+        return -1;
+
+    size_t (*getEnding)(const unsigned char* str, size_t length, RhymeEnding* ending) =
+        RHYME_ENDING_GETTERS[codePage];
+
+    *index = {};
+    index->strIndex       = strIndex;
+    index->numberOfLines  = numberOfLines;
+    index->codePage       = codePage;
+    index->groupsCapacity = RHYME_INDEX_INITIAL_CAPACITY;
+    index->groups         = (RhymeGroup*) calloc(index->groupsCapacity, sizeof(RhymeGroup));
+    if (index->groups == NULL)
+        return -1;
+
+    RhymeEnding ending = {};
+
+    // counting lines of every group
+    for (size_t line = 0; line < numberOfLines; line++)
+    {
+        getEnding(strIndex[line].str, strIndex[line].length, &ending);
+
+        for (size_t length = 1; length <= ending.length; length++)
+        {
+            if (2 * (index->numberOfGroups + 1) > index->groupsCapacity && growRhymeGroups(index) != 0)
+            {
+                destroyRhymeIndex(index);
+                return -1;
+            }
+
+            size_t      hash  = hashRhymeEnding(&ending, length);
+            RhymeGroup* group = findRhymeGroup(index->groups, index->groupsCapacity, &ending, length, hash);
+            if (group->ending.length == 0)
+            {
+                group->ending        = ending;
+                group->ending.length = length;
+                group->hash          = hash;
+                index->numberOfGroups++;
+            }
+
+            group->numberOfLines++;
+        }
+    }
+
+    // placing groups one after another
+    size_t totalLines = 0;
+    for (size_t i = 0; i < index->groupsCapacity; i++)
+    {
+        index->groups[i].firstLine     = totalLines;
+        totalLines                    += index->groups[i].numberOfLines;
+        index->groups[i].numberOfLines = 0;
+    }
+
+    // lines are placed into groups in reverse order, so every group is sorted
+    RhymeIndexLine* sortedLines = (RhymeIndexLine*) calloc(numberOfLines + 1, sizeof(RhymeIndexLine));
+    index->lines                = (size_t*)         calloc(totalLines + 1,    sizeof(size_t));
+    if (sortedLines == NULL || index->lines == NULL)
+    {
+        free(sortedLines);
+        destroyRhymeIndex(index);
+        return -1;
+    }
+
+    for (size_t line = 0; line < numberOfLines; line++)
+        sortedLines[line] = { strIndex[line], line };
+
+    qsort(sortedLines, numberOfLines, sizeof(RhymeIndexLine), getStrComparators(codePage)->reversely);
+
+    for (size_t i = 0; i < numberOfLines; i++)
+    {
+        size_t line = sortedLines[i].number;
+        getEnding(strIndex[line].str, strIndex[line].length, &ending);
+
+        for (size_t length = 1; length <= ending.length; length++)
+        {
+            RhymeGroup* group = findRhymeGroup(index->groups, index->groupsCapacity, &ending, length,
+                                               hashRhymeEnding(&ending, length));
+
+            index->lines[group->firstLine + group->numberOfLines++] = line;
+        }
+    }
+
+    free(sortedLines);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Looks for the group of lines ending with the last RHYME_ENDING_LENGTH
+//! letters of suffix (or all of them if there are less).
+//!
+//! @param [in]  index
+//! @param [in]  suffix
+//! @param [in]  suffixLength
+//!
+//! @return the group or NULL if there are no such lines.
+//-----------------------------------------------------------------------------
+static const RhymeGroup* findSuffixRhymeGroup(const RhymeIndex* index, const unsigned char* suffix,
+                                              size_t suffixLength)
+{
+    assert(index  != NULL);
+    assert(suffix != NULL || suffixLength == 0);
+
+    RhymeEnding ending = {};
+    if (index->groups == NULL || RHYME_ENDING_GETTERS[index->codePage](suffix, suffixLength, &ending) == 0)
+        return NULL;
+
+    const RhymeGroup* group = findRhymeGroup(index->groups, index->groupsCapacity, &ending, ending.length,
+                                             hashRhymeEnding(&ending, ending.length));
+
+    return group->ending.length == 0 ? NULL : group;
+}
+
+//-----------------------------------------------------------------------------
+//! Finds all lines ending with suffix (punctuation marks, latin letters and
+//! case are ignored). Lines ending with the last RHYME_ENDING_LENGTH letters
+//! of suffix are found in O(1). If suffix is longer, the lines ending with
+//! all of it make up a continuous range of them, as they are in reverse
+//! order, which is found in O(log(numberOfLines)).
+//!
+//! @param [in]   index
+//! @param [in]   suffix
+//! @param [in]   suffixLength
+//! @param [out]  lines  numbers of lines found (positions in strIndex)
+//!
+//! @return number of lines found.
+//-----------------------------------------------------------------------------
+size_t findRhymes(const RhymeIndex* index, const unsigned char* suffix, size_t suffixLength,
+                  const size_t** lines)
+{
+    assert(index  != NULL);
+    assert(suffix != NULL || suffixLength == 0);
+    assert(lines  != NULL);
+
+    *lines = NULL;
+
+    const RhymeGroup* group = findSuffixRhymeGroup(index, suffix, suffixLength);
+    if (group == NULL)
+        return 0;
+
+    const size_t* groupLines = index->lines + group->firstLine;
+    string        key        = { (unsigned char*) suffix, suffixLength };
+    int         (*compare)(const string* str, const string* suffix) = getStrComparators(index->codePage)->suffix;
+
+    // first line not less than suffix
+    size_t left  = 0;
+    size_t right = group->numberOfLines;
+    while (left < right)
+    {
+        size_t middle = left + (right - left) / 2;
+        if (compare(&index->strIndex[groupLines[middle]], &key) < 0)
+            left = middle + 1;
+        else
+            right = middle;
+    }
+
+    size_t first = left;
+
+    // first line greater than suffix
+    right = group->numberOfLines;
+    while (left < right)
+    {
+        size_t middle = left + (right - left) / 2;
+        if (compare(&index->strIndex[groupLines[middle]], &key) <= 0)
+            left = middle + 1;
+        else
+            right = middle;
+    }
+
+    *lines = groupLines + first;
+    return left - first;
+}
+
+//-----------------------------------------------------------------------------
+//! Finds all lines with the same last RHYME_ENDING_LENGTH letters as line
+//! (including line itself). Only these letters are matched, the rest of the
+//! line doesn't have to be the same. Takes O(1).
+//!
+//! @param [in]   index
+//! @param [in]   line  position in strIndex
+//! @param [out]  lines
+//!
+//! @return number of lines found.
+//-----------------------------------------------------------------------------
+size_t findLineRhymes(const RhymeIndex* index, size_t line, const size_t** lines)
+{
+    assert(index != NULL);
+    assert(lines != NULL);
+
+    *lines = NULL;
+    if (line >= index->numberOfLines)
+        return 0;
+
+    const RhymeGroup* group = findSuffixRhymeGroup(index, index->strIndex[line].str, index->strIndex[line].length);
+    if (group == NULL)
+        return 0;
+
+    *lines = index->lines + group->firstLine;
+    return group->numberOfLines;
+}
+
+//-----------------------------------------------------------------------------
+//! Comparator of rhyme groups' endings in codePage in reverse (rhyme) order
+//! for qsort.
+//-----------------------------------------------------------------------------
+template <CodePage codePage>
+static int rhymeGroupCmp(const void* value1, const void* value2)
+{
+    const RhymeEnding* ending1 = &(*(const RhymeGroup* const*) value1)->ending;
+    const RhymeEnding* ending2 = &(*(const RhymeGroup* const*) value2)->ending;
+
+    for (size_t i = 0; i < ending1->length && i < ending2->length; i++)
+        if (ending1->symbols[i] != ending2->symbols[i])
+            return collationWeight<codePage>(ending1->symbols[i]) -
+                   collationWeight<codePage>(ending2->symbols[i]);
+
+    return (int) ending1->length - (int) ending2->length;
+}
+
+// in the order of CodePage
+static int (* const RHYME_GROUP_COMPARATORS[CODE_PAGES_NUMBER])(const void* value1, const void* value2) =
+    { rhymeGroupCmp<CODE_PAGE_CP1251>, rhymeGroupCmp<CODE_PAGE_KOI8_R>, rhymeGroupCmp<CODE_PAGE_ISO_8859_5> };
+
+//-----------------------------------------------------------------------------
+//! Writes clusters of rhyming lines (at least two lines with the same ending
+//! of RHYME_ENDING_LENGTH letters) to outputFile. Clusters are written in
+//! order of their endings read from right to left.
+//!
+//! @param [out]  outputFile
+//! @param [in]   index
+//!
+//! @return 0 if there was no error and non-zero value otherwise.
+//-----------------------------------------------------------------------------
+int writeRhymeClusters(File* outputFile, const RhymeIndex* index)
+{
+    if (outputFile == NULL || index == NULL)
+        return -1;
+
+    const RhymeGroup** clusters = (const RhymeGroup**) calloc(index->numberOfGroups + 1, sizeof(RhymeGroup*));
+    if (clusters == NULL)
+        return -1;
+
+    size_t numberOfClusters = 0;
+    for (size_t i = 0; i < index->groupsCapacity; i++)
+        if (index->groups[i].ending.length == RHYME_ENDING_LENGTH && index->groups[i].numberOfLines > 1)
+            clusters[numberOfClusters++] = &index->groups[i];
+
+    qsort(clusters, numberOfClusters, sizeof(RhymeGroup*), RHYME_GROUP_COMPARATORS[index->codePage]);
+
+    for (size_t i = 0; i < numberOfClusters; i++)
+    {
+        writeString(outputFile, "\n-");
+        for (size_t j = RHYME_ENDING_LENGTH; j > 0; j--)
+            writeChar(outputFile, (char) clusters[i]->ending.symbols[j - 1]);
+        writeChar(outputFile, '\n');
+
+        for (size_t j = 0; j < clusters[i]->numberOfLines; j++)
+        {
+            const string* line = &index->strIndex[index->lines[clusters[i]->firstLine + j]];
+            writeBufferToFile(outputFile, sizeof(unsigned char), line->length, line->str);
+            writeChar(outputFile, '\n');
+        }
+    }
+
+    free(clusters);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Frees memory allocated by buildRhymeIndex.
+//!
+//! @param [out]  index
+//-----------------------------------------------------------------------------
+void destroyRhymeIndex(RhymeIndex* index)
+{
+    if (index == NULL)
+        return;
+
+    free(index->groups);
+    free(index->lines);
+
+    *index = {};
+}
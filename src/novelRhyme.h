@@ -0,0 +1,54 @@
+#pragma once
+
+#include "ioLib.h"
+#include "novelSort.h"
+
+constexpr size_t RHYME_ENDING_LENGTH          = 3;
+constexpr size_t RHYME_INDEX_INITIAL_CAPACITY = 1024;
+
+//-----------------------------------------------------------------------------
+//! Last letters of a line normalized the same way the reverse comparator of
+//! a code page compares them: punctuation marks and latin letters are skipped, letters
+//! are lower cased. symbols[0] is the last letter of the line.
+//-----------------------------------------------------------------------------
+struct RhymeEnding
+{
+    unsigned char symbols[RHYME_ENDING_LENGTH] = {};
+    size_t        length                       = 0;
+};
+
+struct RhymeGroup
+{
+    RhymeEnding ending        = {};
+    size_t      hash          = 0;
+    size_t      firstLine     = 0;
+    size_t      numberOfLines = 0;
+};
+
+//-----------------------------------------------------------------------------
+//! Groups of lines by their endings of every length from 1 to
+//! RHYME_ENDING_LENGTH. groups is an open addressing hash table, lines of each
+//! group are stored contiguously in lines starting from group.firstLine.
+//! Lines are in codePage.
+//-----------------------------------------------------------------------------
+struct RhymeIndex
+{
+    string*     strIndex       = NULL;
+    size_t      numberOfLines  = 0;
+    CodePage    codePage       = DEFAULT_CODE_PAGE;
+
+    RhymeGroup* groups         = NULL;
+    size_t      groupsCapacity = 0;
+    size_t      numberOfGroups = 0;
+
+    size_t*     lines          = NULL;
+};
+
+template <CodePage codePage>
+size_t getRhymeEnding     (const unsigned char* str, size_t length, RhymeEnding* ending);
+int    buildRhymeIndex    (RhymeIndex* index, string* strIndex, size_t numberOfLines, CodePage codePage);
+size_t findRhymes         (const RhymeIndex* index, const unsigned char* suffix, size_t suffixLength,
+                           const size_t** lines);
+size_t findLineRhymes     (const RhymeIndex* index, size_t line, const size_t** lines);
+int    writeRhymeClusters (File* outputFile, const RhymeIndex* index);
+void   destroyRhymeIndex  (RhymeIndex* index);
@@ -0,0 +1,332 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "novelServer.h"
+
+//-----------------------------------------------------------------------------
+//! Loads novel from fileName and sorts two copies of its index alphabetically
+//! and reversely, so that the server doesn't have to do it for every query.
+//!
+//! @param [out]  corpus
+//! @param [in]   fileName  has to live as long as the corpus does
+//! @param [in]   codePage  encoding of the file
+//!
+//! @return 0 if there was no error and non-zero value otherwise.
+//-----------------------------------------------------------------------------
+int loadServerCorpus(ServerCorpus* corpus, const char* fileName, CodePage codePage)
+{
+    if (corpus == NULL || fileName == NULL)
+        return -1;
+
+    *corpus = {};
+    corpus->fileName = fileName;
+
+    if (loadNovel(fileName, codePage, &corpus->novel) != 0)
+        return -1;
+
+    size_t numberOfLines = corpus->novel.numberOfLines;
+
+    corpus->alphabeticalIndex = (string*) calloc(numberOfLines + 1, sizeof(string));
+    corpus->reverseIndex      = (string*) calloc(numberOfLines + 1, sizeof(string));
+    if (corpus->alphabeticalIndex == NULL || corpus->reverseIndex == NULL)
+    {
+        destroyServerCorpus(corpus);
+        return -1;
+    }
+
+    for (size_t line = 0; line < numberOfLines; line++)
+    {
+        corpus->alphabeticalIndex[line] = corpus->novel.strIndex[line];
+        corpus->reverseIndex[line]      = corpus->novel.strIndex[line];
+    }
+
+    const StrComparators* comparators = getStrComparators(codePage);
+    sortStrIndex(corpus->alphabeticalIndex, numberOfLines, comparators->alphabetically, 1);
+    sortStrIndex(corpus->reverseIndex,      numberOfLines, comparators->reversely,      1);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Frees memory allocated by loadServerCorpus.
+//!
+//! @param [out]  corpus
+//-----------------------------------------------------------------------------
+void destroyServerCorpus(ServerCorpus* corpus)
+{
+    if (corpus == NULL)
+        return;
+
+    free(corpus->alphabeticalIndex);
+    free(corpus->reverseIndex);
+    destroyNovel(&corpus->novel);
+
+    *corpus = {};
+}
+
+//-----------------------------------------------------------------------------
+//! Loads all of the corpora the server is going to answer queries about.
+//!
+//! @param [out]  server
+//! @param [in]   fileNames  have to live as long as the server does
+//! @param [in]   numberOfFiles
+//! @param [in]   codePage   encoding of the files
+//!
+//! @return 0 if there was no error and non-zero value otherwise.
+//-----------------------------------------------------------------------------
+int initNovelServer(NovelServer* server, const char* const* fileNames, size_t numberOfFiles,
+                    CodePage codePage)
+{
+    if (server == NULL || fileNames == NULL || numberOfFiles == 0)
+        return -1;
+
+    *server = {};
+    server->corpora = (ServerCorpus*) calloc(numberOfFiles, sizeof(ServerCorpus));
+    if (server->corpora == NULL)
+        return -1;
+
+    for (size_t i = 0; i < numberOfFiles; i++)
+    {
+        if (loadServerCorpus(&server->corpora[i], fileNames[i], codePage) != 0)
+        {
+            destroyNovelServer(server);
+            return -1;
+        }
+
+        server->numberOfCorpora++;
+    }
+
+    return 0;
+}
+
+// The server talks to its client through stdin and stdout, which may be pipes
+// or sockets. ioLib can only open files by name, has no formatted output and
+// can't flush, so this is the only part of the program using stdio directly.
+
+//-----------------------------------------------------------------------------
+//! Writes the answer consisting of numberOfLines strings of strIndex.
+//!
+//! @param [out]  output
+//! @param [in]   strIndex
+//! @param [in]   numberOfLines
+//-----------------------------------------------------------------------------
+static void writeServerLines(FILE* output, const string* strIndex, size_t numberOfLines)
+{
+    assert(output   != NULL);
+    assert(strIndex != NULL || numberOfLines == 0);
+
+    fprintf(output, "OK %zu\n", numberOfLines);
+    for (size_t i = 0; i < numberOfLines; i++)
+    {
+        fwrite(strIndex[i].str, sizeof(unsigned char), strIndex[i].length, output);
+        fputc('\n', output);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Reads a number from str and moves str to the symbol after it.
+//!
+//! @param [in,out]  str
+//! @param [out]     number
+//!
+//! @return 0 if there was no error and non-zero value otherwise.
+//-----------------------------------------------------------------------------
+static int parseServerNumber(char** str, size_t* number)
+{
+    assert(str    != NULL);
+    assert(number != NULL);
+
+    while (**str == ' ')
+        (*str)++;
+
+    char* numberEnd = NULL;
+    *number = (size_t) strtoull(*str, &numberEnd, 10);
+    if (numberEnd == *str || **str == '-')
+        return -1;
+
+    *str = numberEnd;
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Answers a single query. Queries consist of a command and its arguments
+//! separated by spaces:
+//!   corpora                    - list of the loaded corpora
+//!   use <corpus>               - makes corpus (numbered from 0) current
+//!   slice <a|r> <first> <last> - lines from first to last (numbered from 1)
+//!                                of the alphabetical (a) or reverse (r) order
+//!   prefix <text>              - lines starting with text in the
+//!                                alphabetical order
+//!   rhyme <text>               - lines ending with text in the reverse order
+//!   quit                       - stops the server
+//! Text is compared the same way the novels are sorted: punctuation marks,
+//! latin letters and case are ignored. Queries have to be in the code page of
+//! the corpora and be shorter than SERVER_QUERY_MAX_LENGTH. The answer is
+//! either "OK <n>" followed by n lines or "ERROR <reason>".
+//!
+//! @param [in,out]  server
+//! @param [in]      query  without '\n', gets split into the command and its
+//!                         arguments
+//! @param [out]     output
+//!
+//! @return 1 if the server has to stop and 0 otherwise.
+//-----------------------------------------------------------------------------
+int answerServerQuery(NovelServer* server, char* query, FILE* output)
+{
+    assert(server != NULL);
+    assert(query  != NULL);
+    assert(output != NULL);
+
+    while (*query == ' ')
+        query++;
+
+    char* arguments = query;
+    while (*arguments != ' ' && *arguments != '\0')
+        arguments++;
+
+    if (*arguments == ' ')
+        *arguments++ = '\0';
+
+    ServerCorpus* corpus = &server->corpora[server->currentCorpus];
+
+    if (strcmp(query, "quit") == 0)
+    {
+        fprintf(output, "OK 0\n");
+        return 1;
+    }
+    else if (strcmp(query, "corpora") == 0)
+    {
+        fprintf(output, "OK %zu\n", server->numberOfCorpora);
+        for (size_t i = 0; i < server->numberOfCorpora; i++)
+            fprintf(output, "%zu %s %zu%s\n", i, server->corpora[i].fileName,
+                    server->corpora[i].novel.numberOfLines, i == server->currentCorpus ? " *" : "");
+    }
+    else if (strcmp(query, "use") == 0)
+    {
+        size_t number = 0;
+        if (parseServerNumber(&arguments, &number) != 0 || number >= server->numberOfCorpora)
+        {
+            fprintf(output, "ERROR no such corpus\n");
+            return 0;
+        }
+
+        server->currentCorpus = number;
+        fprintf(output, "OK 0\n");
+    }
+    else if (strcmp(query, "slice") == 0)
+    {
+        while (*arguments == ' ')
+            arguments++;
+
+        char   order     = *arguments;
+        size_t firstLine = 0;
+        size_t lastLine  = 0;
+        if ((order != 'a' && order != 'r') || arguments[1] != ' ')
+        {
+            fprintf(output, "ERROR order has to be 'a' or 'r'\n");
+            return 0;
+        }
+
+        arguments++;
+        if (parseServerNumber(&arguments, &firstLine) != 0 || parseServerNumber(&arguments, &lastLine) != 0)
+        {
+            fprintf(output, "ERROR first and last lines have to be non-negative numbers\n");
+            return 0;
+        }
+
+        if (firstLine == 0)
+            firstLine = 1;
+        if (lastLine > corpus->novel.numberOfLines)
+            lastLine = corpus->novel.numberOfLines;
+
+        const string* strIndex = order == 'a' ? corpus->alphabeticalIndex : corpus->reverseIndex;
+        writeServerLines(output, strIndex + firstLine - 1, lastLine >= firstLine ? lastLine - firstLine + 1 : 0);
+    }
+    else if (strcmp(query, "prefix") == 0 || strcmp(query, "rhyme") == 0)
+    {
+        const StrComparators* comparators = getStrComparators(corpus->novel.codePage);
+
+        bool    isPrefix = query[0] == 'p';
+        string  key      = { (unsigned char*) arguments, strlen(arguments) };
+        size_t  first    = 0;
+        size_t  found    = findStrIndexRange(isPrefix ? corpus->alphabeticalIndex : corpus->reverseIndex,
+                                             corpus->novel.numberOfLines, &key,
+                                             isPrefix ? comparators->prefix : comparators->suffix,
+                                             &first);
+
+        writeServerLines(output, (isPrefix ? corpus->alphabeticalIndex : corpus->reverseIndex) + first, found);
+    }
+    else
+    {
+        fprintf(output, "ERROR unknown command\n");
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Answers queries read from input line by line until "quit" or the end of
+//! input (see answerServerQuery). Every answer is flushed at once, so the
+//! server can be driven through a pipe. Queries that don't fit into
+//! SERVER_QUERY_MAX_LENGTH are skipped up to the end of the line and answered
+//! with "ERROR query too long".
+//!
+//! @param [in,out]  server
+//! @param [in]      input
+//! @param [out]     output
+//!
+//! @return 0 if there was no error and non-zero value otherwise.
+//-----------------------------------------------------------------------------
+int runNovelServer(NovelServer* server, FILE* input, FILE* output)
+{
+    if (server == NULL || server->numberOfCorpora == 0 || input == NULL || output == NULL)
+        return -1;
+
+    char query[SERVER_QUERY_MAX_LENGTH] = {};
+
+    int stop = 0;
+    while (!stop && fgets(query, SERVER_QUERY_MAX_LENGTH, input) != NULL)
+    {
+        size_t length = strlen(query);
+        if (length == SERVER_QUERY_MAX_LENGTH - 1 && query[length - 1] != '\n')
+        {
+            int symbol = fgetc(input);
+            if (symbol != '\n' && symbol != EOF)
+            {
+                while (symbol != '\n' && symbol != EOF)
+                    symbol = fgetc(input);
+
+                fprintf(output, "ERROR query too long\n");
+                fflush(output);
+                continue;
+            }
+        }
+
+        while (length != 0 && (query[length - 1] == '\n' || query[length - 1] == '\r'))
+            query[--length] = '\0';
+
+        stop = answerServerQuery(server, query, output);
+        fflush(output);
+    }
+
+    return ferror(output) ? -1 : 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Frees memory allocated by initNovelServer.
+//!
+//! @param [out]  server
+//-----------------------------------------------------------------------------
+void destroyNovelServer(NovelServer* server)
+{
+    if (server == NULL)
+        return;
+
+    for (size_t i = 0; i < server->numberOfCorpora; i++)
+        destroyServerCorpus(&server->corpora[i]);
+
+    free(server->corpora);
+
+    *server = {};
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdio.h>
+
+#include "ioLib.h"
+#include "novelIndex.h"
+
+constexpr size_t SERVER_QUERY_MAX_LENGTH = 1024;
+
+//-----------------------------------------------------------------------------
+//! Novel kept in memory by the server along with both of its sorted orders.
+//-----------------------------------------------------------------------------
+struct ServerCorpus
+{
+    const char* fileName          = NULL;
+    Novel       novel             = {};
+    string*     alphabeticalIndex = NULL;
+    string*     reverseIndex      = NULL;
+};
+
+//-----------------------------------------------------------------------------
+//! Server answering queries about corpora loaded once at start (see
+//! answerServerQuery for the protocol).
+//-----------------------------------------------------------------------------
+struct NovelServer
+{
+    ServerCorpus* corpora         = NULL;
+    size_t        numberOfCorpora = 0;
+    size_t        currentCorpus   = 0;
+};
+
+int  loadServerCorpus    (ServerCorpus* corpus, const char* fileName, CodePage codePage);
+void destroyServerCorpus (ServerCorpus* corpus);
+int  initNovelServer     (NovelServer* server, const char* const* fileNames, size_t numberOfFiles,
+                          CodePage codePage);
+int  answerServerQuery   (NovelServer* server, char* query, FILE* output);
+int  runNovelServer      (NovelServer* server, FILE* input, FILE* output);
+void destroyNovelServer  (NovelServer* server);
@@ -1,4 +1,12 @@
+#include <stdint.h>
 #include <assert.h>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NOVEL_SORT_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 #include "ioLib.h"
 #include "novelSort.h"
@@ -25,37 +33,120 @@ void swapValues(void* value1, void* value2, size_t valueSize)
 }
 
 //-----------------------------------------------------------------------------
-//! Partitioning function for quick sort. Chooses the last elements as pivot. 
+//! Picks a pseudo-random index from left to right. It only depends on left,
+//! right and salt, so sorting stays deterministic and thread-safe, and
+//! neither sorted values nor the ones rearranged by previous partitions
+//! make the pivot bad. Values crafted against these indices still can.
+//!
+//! @param [in]  left
+//! @param [in]  right
+//! @param [in]  salt
+//!
+//! @return the index.
+//-----------------------------------------------------------------------------
+static size_t pseudoRandomIndex(size_t left, size_t right, uint64_t salt)
+{
+    uint64_t hash = ((uint64_t) left * 0x9E3779B97F4A7C15u) ^ ((uint64_t) right + salt) * 0xC2B2AE3D27D4EB4Fu;
+    hash ^= hash >> 29;
+    hash *= 0xBF58476D1CE4E5B9u;
+    hash ^= hash >> 32;
+
+    return left + (size_t) (hash % (right - left + 1));
+}
+
+//-----------------------------------------------------------------------------
+//! Moves the median of three pseudo-random values from left to right to
+//! values[left], so that the pivot is close to the median of all values 
+//! regardless of their order.
+//!
+//! @param [out]  values  
+//! @param [in]   left
+//! @param [in]   right
+//! @param [in]   valueSize
+//! @param [in]   compare
+//-----------------------------------------------------------------------------
+static void moveMedianOfThreeToLeft(void* values, size_t left, size_t right, size_t valueSize, 
+                                    int (*compare)(const void* value1, const void* value2))
+{
+    char* value1 = (char*)values + pseudoRandomIndex(left, right, 1) * valueSize;
+    char* value2 = (char*)values + pseudoRandomIndex(left, right, 2) * valueSize;
+    char* value3 = (char*)values + pseudoRandomIndex(left, right, 3) * valueSize;
+
+    char* median = NULL;
+    if (compare(value1, value2) < 0)
+        median = compare(value2, value3) < 0 ? value2 : (compare(value1, value3) < 0 ? value3 : value1);
+    else
+        median = compare(value1, value3) < 0 ? value1 : (compare(value2, value3) < 0 ? value3 : value2);
+
+    char* leftValue = (char*)values + left * valueSize;
+    if (median != leftValue)
+        swapValues(leftValue, median, valueSize);
+}
+
+//-----------------------------------------------------------------------------
+//! Partitioning function for quick sort. Chooses the median of three 
+//! pseudo-random values as pivot and splits values into three 
+//! parts: less than, equal to and greater than pivot, so that equal values
+//! don't make quick sort quadratic. Quick sort takes O(n log n) expected
+//! time on any order of values, but the pivot is only pseudo-random, so
+//! input crafted against pseudoRandomIndex can still make it quadratic.
 //!
 //! @param [out]  values  
 //! @param [in]   left
 //! @param [in]   right
 //! @param [in]   valueSize
 //! @param [in]   compare
+//! @param [out]  pivotEnd  index of the last value equal to the pivot
 //! 
-//! @return index of the pivot.
+//! @return index of the first value equal to the pivot.
 //-----------------------------------------------------------------------------
-size_t qsortPartition(void* values, size_t left, size_t right, size_t valueSize, int (*compare)(const void* value1, const void* value2))
+size_t qsortPartition(void* values, size_t left, size_t right, size_t valueSize, 
+                      int (*compare)(const void* value1, const void* value2), size_t* pivotEnd)
 {
-    size_t indexOfResultPivot = left;
-    void* pivot = (char*)values + right * valueSize;
-    for (size_t i = left; i < right; i++)
+    assert(values   != NULL);
+    assert(compare  != NULL);
+    assert(pivotEnd != NULL);
+    assert(left     <= right);
+
+    moveMedianOfThreeToLeft(values, left, right, valueSize, compare);
+
+    // [left, less) < pivot, [less, i) == pivot, (greater, right] > pivot, 
+    // values[less] is always equal to pivot
+    size_t less    = left;
+    size_t greater = right;
+    size_t i       = left + 1;
+    while (i <= greater)
     {
-        if (compare(((char*)values + i * valueSize), pivot) < 0)
+        char* value = (char*)values + i * valueSize;
+        int   cmp   = compare(value, (char*)values + less * valueSize);
+
+        if (cmp < 0)
+        {
+            swapValues((char*)values + less * valueSize, value, valueSize);
+            less++;
+            i++;
+        }
+        else if (cmp > 0)
         {
-            swapValues((void*)((char*)values + indexOfResultPivot * valueSize), (void*)((char*)values + i * valueSize), valueSize);
-            indexOfResultPivot++;
+            swapValues((char*)values + greater * valueSize, value, valueSize);
+            greater--;
+        }
+        else
+        {
+            i++;
         }
     }
 
-    swapValues((void*)((char*)values + indexOfResultPivot * valueSize), (void*)((char*)values + right * valueSize), valueSize);
+    *pivotEnd = greater;
 
-    return indexOfResultPivot;
+    return less;
 }
 
 //-----------------------------------------------------------------------------
 //! Sorts values using compare function. Which returns positive number if
 //! value1 > value2, negative if value1 < value2 and 0 if they are equal.
+//! Recurses only into the smaller part of values, so it takes O(log n) of 
+//! stack.
 //!
 //! @param [out]  values  
 //! @param [in]   left
@@ -65,93 +156,625 @@ size_t qsortPartition(void* values, size_t left, size_t right, size_t valueSize,
 //-----------------------------------------------------------------------------
 void qsort(void* values, size_t left, size_t right, size_t valueSize, int (*compare)(const void* value1, const void* value2))
 {
-    if (left >= right)
+    while (left < right)
+    {
+        size_t pivotEnd   = 0;
+        size_t pivotBegin = qsortPartition(values, left, right, valueSize, compare, &pivotEnd);
+
+        if (pivotBegin - left < right - pivotEnd)
+        {
+            if (pivotBegin != left)
+                qsort(values, left, pivotBegin - 1, valueSize, compare);
+
+            left = pivotEnd + 1;
+        }
+        else
+        {
+            if (pivotEnd != right)
+                qsort(values, pivotEnd + 1, right, valueSize, compare);
+
+            if (pivotBegin == left)
+                return;
+
+            right = pivotBegin - 1;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Partially sorts values using compare, so that values[first..last] become
+//! the same as if all values were sorted. Parts of values that lie outside of
+//! first..last are only partitioned, not sorted, so it takes O(n + K log K)
+//! on average, where K = last - first + 1. Like qsort recurses only into the
+//! smaller part.
+//!
+//! @param [out]  values  
+//! @param [in]   left
+//! @param [in]   right
+//! @param [in]   valueSize
+//! @param [in]   first
+//! @param [in]   last
+//! @param [in]   compare
+//-----------------------------------------------------------------------------
+void qsortRange(void* values, size_t left, size_t right, size_t valueSize, 
+                size_t first, size_t last, int (*compare)(const void* value1, const void* value2))
+{
+    while (left < right && first <= last && first <= right && last >= left)
+    {
+        size_t pivotEnd   = 0;
+        size_t pivotBegin = qsortPartition(values, left, right, valueSize, compare, &pivotEnd);
+
+        bool isLeftNeeded  = pivotBegin != left  && pivotBegin > first;
+        bool isRightNeeded = pivotEnd   != right && pivotEnd   < last;
+
+        if (isLeftNeeded && isRightNeeded && pivotBegin - left < right - pivotEnd)
+        {
+            qsortRange(values, left, pivotBegin - 1, valueSize, first, last, compare);
+            left = pivotEnd + 1;
+        }
+        else if (isLeftNeeded && isRightNeeded)
+        {
+            qsortRange(values, pivotEnd + 1, right, valueSize, first, last, compare);
+            right = pivotBegin - 1;
+        }
+        else if (isLeftNeeded)
+        {
+            right = pivotBegin - 1;
+        }
+        else if (isRightNeeded)
+        {
+            left = pivotEnd + 1;
+        }
+        else
+        {
+            return;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Initializes iterator that yields values in the order given by compare.
+//! Values are sorted lazily by incremental quick sort: to yield the next value
+//! only the leftmost unsorted part is partitioned until the next value gets
+//! to its place, so the first value costs O(n) on average and all of them 
+//! together O(n log n). values are reordered in place.
+//!
+//! @param [out]  iterator
+//! @param [in]   values
+//! @param [in]   count
+//! @param [in]   valueSize
+//! @param [in]   compare
+//!
+//! @return 0 if there was no error and non-zero value otherwise.
+//-----------------------------------------------------------------------------
+int sortedIteratorInit(SortedIterator* iterator, void* values, size_t count, size_t valueSize, 
+                       int (*compare)(const void* value1, const void* value2))
+{
+    if (iterator == NULL || (values == NULL && count != 0) || valueSize == 0 || compare == NULL)
+        return -1;
+
+    iterator->values         = values;
+    iterator->count          = count;
+    iterator->valueSize      = valueSize;
+    iterator->compare        = compare;
+    iterator->next           = 0;
+    iterator->error          = 0;
+    iterator->pivotsCapacity = SORTED_ITERATOR_INITIAL_CAPACITY;
+    iterator->pivotsCount    = 0;
+    iterator->pivots         = (size_t*) calloc(2 * iterator->pivotsCapacity, sizeof(size_t));
+    if (iterator->pivots == NULL)
+        return -1;
+
+    // empty run after the last value is the first one
+    iterator->pivots[0] = count;
+    iterator->pivots[1] = count;
+    iterator->pivotsCount++;
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//! Yields the next value in sorted order.
+//!
+//! @param [out]  iterator
+//!
+//! @return pointer to the next value or NULL if there are no values left or
+//!         there was an error (iterator->error is set then).
+//-----------------------------------------------------------------------------
+void* sortedIteratorNext(SortedIterator* iterator)
+{
+    assert(iterator != NULL);
+
+    if (iterator->next >= iterator->count)
+        return NULL;
+
+    // top run is [pivots[2 * top], pivots[2 * top + 1])
+    size_t top = iterator->pivotsCount - 1;
+    while (iterator->pivots[2 * top] != iterator->next)
+    {
+        if (iterator->pivotsCount == iterator->pivotsCapacity)
+        {
+            size_t* newPivots = (size_t*) realloc(iterator->pivots, 4 * iterator->pivotsCapacity * sizeof(size_t));
+            if (newPivots == NULL)
+            {
+                iterator->error = -1;
+                return NULL;
+            }
+
+            iterator->pivots          = newPivots;
+            iterator->pivotsCapacity *= 2;
+        }
+
+        size_t pivotEnd   = 0;
+        size_t pivotBegin = qsortPartition(iterator->values, iterator->next, iterator->pivots[2 * top] - 1, 
+                                           iterator->valueSize, iterator->compare, &pivotEnd);
+
+        top = iterator->pivotsCount++;
+        iterator->pivots[2 * top]     = pivotBegin;
+        iterator->pivots[2 * top + 1] = pivotEnd + 1;
+    }
+
+    // values of the run are equal, so they are yielded one by one without partitioning
+    if (++iterator->pivots[2 * top] == iterator->pivots[2 * top + 1])
+        iterator->pivotsCount--;
+
+    return (char*)iterator->values + (iterator->next++) * iterator->valueSize;
+}
+
+//-----------------------------------------------------------------------------
+//! Frees memory allocated by sortedIteratorInit.
+//!
+//! @param [out]  iterator
+//-----------------------------------------------------------------------------
+void sortedIteratorDestroy(SortedIterator* iterator)
+{
+    if (iterator == NULL)
+        return;
+
+    free(iterator->pivots);
+    *iterator = {};
+}
+
+//-----------------------------------------------------------------------------
+//! Sorts numberOfLines strings of strIndex using compare. If useDefaultQSort
+//! is 0 then uses qsort from novelSort.h otherwise uses standard qsort.
+//!
+//! @param [out]  strIndex  
+//! @param [in]   numberOfLines
+//! @param [in]   compare
+//! @param [in]   useDefaultQSort
+//-----------------------------------------------------------------------------
+void sortStrIndex(string* strIndex, size_t numberOfLines,
+                  int (*compare)(const void* value1, const void* value2),
+                  int useDefaultQSort)
+{
+    assert(strIndex != NULL);
+    assert(compare  != NULL);
+
+    if (numberOfLines == 0)
         return;
 
-    size_t mid = qsortPartition(values, left, right, valueSize, compare);
-    if (mid != 0)
+    if (useDefaultQSort)
+        qsort((void*) strIndex, numberOfLines, sizeof(string), compare);
+    else
+        qsort((void*) strIndex, 0, numberOfLines - 1, sizeof(string), compare);
+}
+
+//-----------------------------------------------------------------------------
+//! Sorts strIndex just enough to put the right strings to positions from
+//! first to last (see qsortRange). last is clamped to numberOfLines - 1.
+//!
+//! @param [out]  strIndex  
+//! @param [in]   numberOfLines
+//! @param [in]   compare
+//! @param [in]   first
+//! @param [in]   last
+//!
+//! @return number of strings in range first..last after clamping.
+//-----------------------------------------------------------------------------
+size_t sortStrIndexRange(string* strIndex, size_t numberOfLines,
+                         int (*compare)(const void* value1, const void* value2),
+                         size_t first, size_t last)
+{
+    assert(strIndex != NULL);
+    assert(compare  != NULL);
+
+    if (numberOfLines == 0 || first >= numberOfLines || first > last)
+        return 0;
+
+    if (last >= numberOfLines)
+        last = numberOfLines - 1;
+
+    qsortRange((void*) strIndex, 0, numberOfLines - 1, sizeof(string), first, last, compare);
+
+    return last - first + 1;
+}
+
+#if defined(NOVEL_SORT_SSE2)
+//-----------------------------------------------------------------------------
+//! @param [in]  mask  non-zero
+//!
+//! @return index of the lowest set bit of mask.
+//-----------------------------------------------------------------------------
+static inline unsigned lowestSetBit(unsigned mask)
+{
+    assert(mask != 0);
+
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return (unsigned) index;
+#else
+    return (unsigned) __builtin_ctz(mask);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+//! @param [in]  mask  non-zero
+//!
+//! @return index of the highest set bit of mask.
+//-----------------------------------------------------------------------------
+static inline unsigned highestSetBit(unsigned mask)
+{
+    assert(mask != 0);
+
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanReverse(&index, mask);
+    return (unsigned) index;
+#else
+    return (unsigned) (sizeof(unsigned) * 8 - 1 - __builtin_clz(mask));
+#endif
+}
+
+//-----------------------------------------------------------------------------
+//! @return mask of the bytes of block from first to last (unsigned).
+//-----------------------------------------------------------------------------
+static inline __m128i bytesInRange(__m128i block, unsigned char first, unsigned char last)
+{
+    __m128i offset = _mm_sub_epi8(block, _mm_set1_epi8((char) first));
+    return _mm_cmpeq_epi8(_mm_subs_epu8(offset, _mm_set1_epi8((char) (last - first))), _mm_setzero_si128());
+}
+
+//-----------------------------------------------------------------------------
+//! Same as foldSymbol, but for COMPARE_BLOCK_SIZE symbols at once.
+//!
+//! @param [in]  block
+//!
+//! @return the keys of the symbols.
+//-----------------------------------------------------------------------------
+template <CodePage codePage>
+static inline __m128i foldBlock(__m128i block)
+{
+    constexpr CaseFolding folding = CASE_FOLDING<codePage>;
+
+    __m128i isUpper   = bytesInRange(block, folding.upperFirst,
+                                     (unsigned char) (folding.upperFirst + ALPHABET_LENGTH - 2));
+    __m128i isYo      = _mm_cmpeq_epi8(block, _mm_set1_epi8((char) folding.upperYo));
+    __m128i isSkipped = _mm_andnot_si128(bytesInRange(block, '0', '9'), bytesInRange(block, ' ', '~'));
+
+    block = _mm_add_epi8(block, _mm_and_si128(isUpper, _mm_set1_epi8((char) folding.lowerOffset)));
+    block = _mm_or_si128(_mm_andnot_si128(isYo, block), _mm_and_si128(isYo, _mm_set1_epi8((char) folding.lowerYo)));
+
+    return _mm_andnot_si128(isSkipped, block);
+}
+
+//-----------------------------------------------------------------------------
+//! @return mask with bit i set if symbols i of the blocks have different
+//!         keys (see foldSymbol).
+//-----------------------------------------------------------------------------
+template <CodePage codePage>
+static inline unsigned foldedMismatch(const unsigned char* block1, const unsigned char* block2)
+{
+    __m128i keys1 = foldBlock<codePage>(_mm_loadu_si128((const __m128i*) block1));
+    __m128i keys2 = foldBlock<codePage>(_mm_loadu_si128((const __m128i*) block2));
+
+    return ~(unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(keys1, keys2)) & 0xFFFF;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+//! Counts how many first symbols of str1 and str2 have equal collation
+//! weights in codePage. Such symbols are either skipped in both strings or
+//! equal, so the comparators don't have to look at them. Compares
+//! COMPARE_BLOCK_SIZE symbols at once with SSE2 if it's available, ignoring
+//! case and ASCII punctuation marks (see foldSymbol).
+//!
+//! @param [in]  str1
+//! @param [in]  str2
+//! @param [in]  maxLength  number of bytes both strings have
+//!
+//! @return length of the common prefix.
+//-----------------------------------------------------------------------------
+template <CodePage codePage>
+static size_t commonPrefixLength(const unsigned char* str1, const unsigned char* str2, size_t maxLength)
+{
+    size_t length = 0;
+
+#if defined(NOVEL_SORT_SSE2)
+    for (; length + COMPARE_BLOCK_SIZE <= maxLength; length += COMPARE_BLOCK_SIZE)
     {
-        qsort(values, left, mid - 1L, valueSize, compare);
+        unsigned mismatch = foldedMismatch<codePage>(str1 + length, str2 + length);
+        if (mismatch != 0)
+        {
+            length += lowestSetBit(mismatch);
+            break;
+        }
     }
+#endif
 
-    qsort(values, mid + 1L, right, valueSize, compare);
+    while (length < maxLength && collationWeight<codePage>(str1[length]) ==
+                                 collationWeight<codePage>(str2[length]))
+        length++;
 
+    return length;
 }
 
 //-----------------------------------------------------------------------------
-//! Alphabetical string comparator for qsort. 
+//! Same as commonPrefixLength, but for the last symbols of str1 and str2.
+//!
+//! @param [in]  end1       pointer to the byte after the last one of str1
+//! @param [in]  end2       pointer to the byte after the last one of str2
+//! @param [in]  maxLength  number of bytes both strings have
 //!
-//! @param [in]  str1  
+//! @return length of the common suffix.
+//-----------------------------------------------------------------------------
+template <CodePage codePage>
+static size_t commonSuffixLength(const unsigned char* end1, const unsigned char* end2, size_t maxLength)
+{
+    size_t length = 0;
+
+#if defined(NOVEL_SORT_SSE2)
+    for (; length + COMPARE_BLOCK_SIZE <= maxLength; length += COMPARE_BLOCK_SIZE)
+    {
+        // the last symbol of the block is bit COMPARE_BLOCK_SIZE - 1
+        unsigned mismatch = foldedMismatch<codePage>(end1 - length - COMPARE_BLOCK_SIZE,
+                                                     end2 - length - COMPARE_BLOCK_SIZE);
+        if (mismatch != 0)
+        {
+            length += COMPARE_BLOCK_SIZE - 1 - highestSetBit(mismatch);
+            break;
+        }
+    }
+#endif
+
+    while (length < maxLength && collationWeight<codePage>(*(end1 - length - 1)) ==
+                                 collationWeight<codePage>(*(end2 - length - 1)))
+        length++;
+
+    return length;
+}
+
+//-----------------------------------------------------------------------------
+//! Compares str1 and str2 from left to right skipping punctuation marks and
+//! latin letters, letters are compared by their collation weights in
+//! codePage. Strings are compared within their lengths, so it doesn't depend
+//! on the string termination symbol and can be used by several threads at
+//! once. The common prefix of the strings is skipped at once (see
+//! commonPrefixLength). If isPrefix is true, str1 is considered equal to str2
+//! if it starts with it.
+//!
+//! @param [in]  str1
 //! @param [in]  str2
-//! 
-//! @return positive number if str1 > str2, negative if str1 < str2 and 0 if 
+//!
+//! @return positive number if str1 > str2, negative if str1 < str2 and 0 if
 //!         they are equal.
 //-----------------------------------------------------------------------------
-int strCmpForSortAlphabetically(void *str1, void *str2)
-{	
-    unsigned char* ptr1 = (*((string*) str1)).str;
-    unsigned char* ptr2 = (*((string*) str2)).str;
+template <CodePage codePage, bool isPrefix>
+static int compareFromLeft(const string* str1, const string* str2)
+{
+    assert(str1 != NULL);
+    assert(str2 != NULL);
+
+    const unsigned char* ptr1 = str1->str;
+    const unsigned char* ptr2 = str2->str;
+    const unsigned char* end1 = ptr1 + str1->length;
+    const unsigned char* end2 = ptr2 + str2->length;
+
+    // symbols with equal weights are either skipped or equal in both strings,
+    // so only the rest of the strings after their common prefix is compared
+    size_t commonLength = commonPrefixLength<codePage>(ptr1, ptr2, end1 - ptr1 < end2 - ptr2 ? end1 - ptr1 : end2 - ptr2);
+    ptr1 += commonLength;
+    ptr2 += commonLength;
 
-    unsigned char strTermination = getStringTermination();
+    uint16_t weight1 = 0;
+    uint16_t weight2 = 0;
     while(true)
     {
-        if (isPunctuationMark(*ptr1) || isLatinLetter(*ptr1))
+        weight1 = ptr1 == end1 ? 0 : collationWeight<codePage>(*ptr1);
+        if (ptr1 != end1 && weight1 == 0)
         {
             ptr1++;
             continue;
         }
 
-        if (isPunctuationMark(*ptr2) || isLatinLetter(*ptr2))
+        weight2 = ptr2 == end2 ? 0 : collationWeight<codePage>(*ptr2);
+        if (ptr2 != end2 && weight2 == 0)
         {
             ptr2++;
             continue;
         }
 
-        if (*ptr1 == strTermination || *ptr2 == strTermination || toLowerCase(*ptr1) != toLowerCase(*ptr2))
+        if (isPrefix && ptr2 == end2)
+            return 0;
+
+        if (ptr1 == end1 || ptr2 == end2 || weight1 != weight2)
             break;
 
         ptr1++;
         ptr2++;
     }
 
-    return toLowerCase(*ptr1) - toLowerCase(*ptr2);
+    return (int) weight1 - (int) weight2;
 }
 
 //-----------------------------------------------------------------------------
-//! Reverse string comparator for qsort. 
+//! Same as compareFromLeft, but compares strings from right to left. If
+//! isSuffix is true, str1 is considered equal to str2 if it ends with it.
 //!
-//! @param [in]  str1  
+//! @param [in]  str1
 //! @param [in]  str2
-//! 
-//! @return positive number if str1 > str2, negative if str1 < str2 and 0 if 
+//!
+//! @return positive number if str1 > str2, negative if str1 < str2 and 0 if
 //!         they are equal.
 //-----------------------------------------------------------------------------
-int strCmpForSortReversely(void *str1, void *str2)
-{	
-    unsigned char* ptr1 = (*((string*) str1)).str + (*((string*) str1)).length - 1;
-    unsigned char* ptr2 = (*((string*) str2)).str + (*((string*) str2)).length - 1;
+template <CodePage codePage, bool isSuffix>
+static int compareFromRight(const string* str1, const string* str2)
+{
+    assert(str1 != NULL);
+    assert(str2 != NULL);
 
-    unsigned char strTermination = getStringTermination();
+    // ptr points to the symbol after the current one
+    const unsigned char* begin1 = str1->str;
+    const unsigned char* begin2 = str2->str;
+    const unsigned char* ptr1   = begin1 + str1->length;
+    const unsigned char* ptr2   = begin2 + str2->length;
+
+    // same as in compareFromLeft, but for the common suffix
+    size_t commonLength = commonSuffixLength<codePage>(ptr1, ptr2, ptr1 - begin1 < ptr2 - begin2 ? ptr1 - begin1 : ptr2 - begin2);
+    ptr1 -= commonLength;
+    ptr2 -= commonLength;
+
+    uint16_t weight1 = 0;
+    uint16_t weight2 = 0;
     while(true)
     {
-        if (isPunctuationMark(*ptr1) || isLatinLetter(*ptr1))
+        weight1 = ptr1 == begin1 ? 0 : collationWeight<codePage>(*(ptr1 - 1));
+        if (ptr1 != begin1 && weight1 == 0)
         {
             ptr1--;
             continue;
         }
 
-        if (isPunctuationMark(*ptr2) || isLatinLetter(*ptr2))
+        weight2 = ptr2 == begin2 ? 0 : collationWeight<codePage>(*(ptr2 - 1));
+        if (ptr2 != begin2 && weight2 == 0)
         {
             ptr2--;
             continue;
         }
 
-        if (*ptr1 == strTermination || *ptr2 == strTermination || toLowerCase(*ptr1) != toLowerCase(*ptr2))
+        if (isSuffix && ptr2 == begin2)
+            return 0;
+
+        if (ptr1 == begin1 || ptr2 == begin2 || weight1 != weight2)
             break;
 
         ptr1--;
         ptr2--;
     }
 
-    return toLowerCase(*ptr1) - toLowerCase(*ptr2);
+    return (int) weight1 - (int) weight2;
+}
+
+//-----------------------------------------------------------------------------
+//! Alphabetical string comparator for qsort (see compareFromLeft).
+//!
+//! @param [in]  str1
+//! @param [in]  str2
+//!
+//! @return positive number if str1 > str2, negative if str1 < str2 and 0 if
+//!         they are equal.
+//-----------------------------------------------------------------------------
+template <CodePage codePage>
+int strCmpAlphabetically(const void* str1, const void* str2)
+{
+    return compareFromLeft<codePage, false>((const string*) str1, (const string*) str2);
+}
+
+//-----------------------------------------------------------------------------
+//! Reverse string comparator for qsort (see compareFromRight).
+//!
+//! @param [in]  str1
+//! @param [in]  str2
+//!
+//! @return positive number if str1 > str2, negative if str1 < str2 and 0 if
+//!         they are equal.
+//-----------------------------------------------------------------------------
+template <CodePage codePage>
+int strCmpReversely(const void* str1, const void* str2)
+{
+    return compareFromRight<codePage, false>((const string*) str1, (const string*) str2);
+}
+
+template int strCmpAlphabetically<CODE_PAGE_CP1251>    (const void* str1, const void* str2);
+template int strCmpAlphabetically<CODE_PAGE_KOI8_R>    (const void* str1, const void* str2);
+template int strCmpAlphabetically<CODE_PAGE_ISO_8859_5>(const void* str1, const void* str2);
+template int strCmpReversely     <CODE_PAGE_CP1251>    (const void* str1, const void* str2);
+template int strCmpReversely     <CODE_PAGE_KOI8_R>    (const void* str1, const void* str2);
+template int strCmpReversely     <CODE_PAGE_ISO_8859_5>(const void* str1, const void* str2);
+
+// in the order of CodePage
+static const StrComparators STR_COMPARATORS[CODE_PAGES_NUMBER] =
+{
+    { strCmpAlphabetically<CODE_PAGE_CP1251>,     strCmpReversely<CODE_PAGE_CP1251>,
+      compareFromLeft<CODE_PAGE_CP1251, true>,     compareFromRight<CODE_PAGE_CP1251, true>     },
+    { strCmpAlphabetically<CODE_PAGE_KOI8_R>,     strCmpReversely<CODE_PAGE_KOI8_R>,
+      compareFromLeft<CODE_PAGE_KOI8_R, true>,     compareFromRight<CODE_PAGE_KOI8_R, true>     },
+    { strCmpAlphabetically<CODE_PAGE_ISO_8859_5>, strCmpReversely<CODE_PAGE_ISO_8859_5>,
+      compareFromLeft<CODE_PAGE_ISO_8859_5, true>, compareFromRight<CODE_PAGE_ISO_8859_5, true> }
+};
+
+//-----------------------------------------------------------------------------
+//! Gets comparators of strings in codePage, so that the code page chosen at
+//! run time picks the comparators instantiated for it.
+//!
+//! @param [in]  codePage
+//!
+//! @return comparators.
+//-----------------------------------------------------------------------------
+const StrComparators* getStrComparators(CodePage codePage)
+{
+    assert(codePage < CODE_PAGES_NUMBER);
+
+    return &STR_COMPARATORS[codePage];
+}
+
+//-----------------------------------------------------------------------------
+//! Finds the range of strIndex sorted with respect to compare, in which
+//! compare(line, key) == 0, using binary search. Takes O(log(numberOfLines))
+//! comparisons.
+//!
+//! @param [in]   strIndex
+//! @param [in]   numberOfLines
+//! @param [in]   key
+//! @param [in]   compare  e.g. StrComparators::prefix
+//! @param [out]  first    position of the first string of the range
+//!
+//! @return number of strings in the range.
+//-----------------------------------------------------------------------------
+size_t findStrIndexRange(const string* strIndex, size_t numberOfLines, const string* key,
+                         int (*compare)(const string* str, const string* key),
+                         size_t* first)
+{
+    assert(strIndex != NULL || numberOfLines == 0);
+    assert(key      != NULL);
+    assert(compare  != NULL);
+    assert(first    != NULL);
+
+    // first string not less than key
+    size_t left  = 0;
+    size_t right = numberOfLines;
+    while (left < right)
+    {
+        size_t middle = left + (right - left) / 2;
+        if (compare(&strIndex[middle], key) < 0)
+            left = middle + 1;
+        else
+            right = middle;
+    }
+
+    *first = left;
+
+    // first string greater than key
+    right = numberOfLines;
+    while (left < right)
+    {
+        size_t middle = left + (right - left) / 2;
+        if (compare(&strIndex[middle], key) <= 0)
+            left = middle + 1;
+        else
+            right = middle;
+    }
+
+    return left - *first;
 }
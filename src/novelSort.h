@@ -2,20 +2,84 @@
 
 #include <stdlib.h>
 
+#include "codePage.h"
+
 struct string
 {
     unsigned char* str    = NULL;
     size_t         length = 0;
 };
 
+constexpr size_t SORTED_ITERATOR_INITIAL_CAPACITY = 64;
+constexpr size_t COMPARE_BLOCK_SIZE               = 16;
+
+//-----------------------------------------------------------------------------
+//! Yields values one by one in sorted order, sorting them only as much as
+//! it's needed to get the next value (see sortedIteratorNext). pivots is a
+//! stack of pivotsCount runs of values equal to some pivot, which are already
+//! in their places: run i is values from pivots[2 * i] to pivots[2 * i + 1]
+//! (not including the last one). error is set if the iterator stopped because
+//! of an error rather than because there are no values left.
+//-----------------------------------------------------------------------------
+struct SortedIterator
+{
+    void*   values         = NULL;
+    size_t  count          = 0;
+    size_t  valueSize      = 0;
+    int   (*compare)(const void* value1, const void* value2) = NULL;
+
+    size_t  next           = 0;
+    size_t* pivots         = NULL;
+    size_t  pivotsCount    = 0;
+    size_t  pivotsCapacity = 0;
+    int     error          = 0;
+};
+
+//-----------------------------------------------------------------------------
+//! String comparators of one code page (see getStrComparators):
+//!   alphabetically - for sorting from left to right
+//!   reversely      - for sorting from right to left
+//!   prefix         - str is equal to prefix if it starts with it
+//!   suffix         - str is equal to suffix if it ends with it
+//-----------------------------------------------------------------------------
+struct StrComparators
+{
+    int (*alphabetically)(const void* str1, const void* str2);
+    int (*reversely)     (const void* str1, const void* str2);
+    int (*prefix)        (const string* str, const string* prefix);
+    int (*suffix)        (const string* str, const string* suffix);
+};
+
 void   swapValues                  (void* value1, void* value2, size_t valueSize);
 size_t qsortPartition              (void*  values, size_t left, 
                                     size_t right,  size_t valueSize, 
-                                    int (*compare)(const void* value1, const void* value2));
+                                    int (*compare)(const void* value1, const void* value2),
+                                    size_t* pivotEnd);
 void   qsort                       (void*  values, size_t left, 
                                     size_t right,  size_t valueSize, 
                                     int (*compare)(const void* value1, const void* value2));
-int    strCmpForSortAlphabetically (void *str1, void *str2);
-int    strCmpForSortReversely      (void *str1, void *str2);
+void   qsortRange                  (void*  values, size_t left, 
+                                    size_t right,  size_t valueSize, 
+                                    size_t first,  size_t last,
+                                    int (*compare)(const void* value1, const void* value2));
+void   sortStrIndex                (string* strIndex, size_t numberOfLines,
+                                    int (*compare)(const void* value1, const void* value2),
+                                    int useDefaultQSort);
+size_t sortStrIndexRange           (string* strIndex, size_t numberOfLines,
+                                    int (*compare)(const void* value1, const void* value2),
+                                    size_t first,  size_t last);
+int    sortedIteratorInit          (SortedIterator* iterator, void* values, 
+                                    size_t count, size_t valueSize,
+                                    int (*compare)(const void* value1, const void* value2));
+void*  sortedIteratorNext          (SortedIterator* iterator);
+void   sortedIteratorDestroy       (SortedIterator* iterator);
+template <CodePage codePage>
+int    strCmpAlphabetically        (const void* str1, const void* str2);
+template <CodePage codePage>
+int    strCmpReversely             (const void* str1, const void* str2);
+const StrComparators* getStrComparators(CodePage codePage);
+size_t findStrIndexRange           (const string* strIndex, size_t numberOfLines, const string* key,
+                                    int (*compare)(const string* str, const string* key),
+                                    size_t* first);
 
 
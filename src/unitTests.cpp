@@ -1,8 +1,12 @@
+#include <stdlib.h>
 #include <assert.h>
+#include <math.h>
+#include <time.h>
 
 #include "ioLib.h"
 #include "novelClean.h"
 #include "novelSort.h"
+#include "novelRhyme.h"
 #include "unitTests.h"
 
 static const size_t TITLE_MESSAGE_LENGTH = 49;
@@ -11,6 +15,16 @@ void testAll()
 {
     testSwap               ();
     testQSort              ();
+    testQSortRange         ();
+    testSortedIterator     ();
+    testFindRhymes         ();
+    testRemoveDuplicates   ();
+    testFindStrIndexRange  ();
+    testCollationWeight    ();
+    testBlockBoundaries    ();
+    testQSortScaling       ();
+    testCleanNovelLastLine ();
+    testCodePages          ();
     testToLowerCase        ();
     testStrNumOfOccurrences();
     testIsCyrilicLetter    ();
@@ -122,7 +136,7 @@ void testQSort()
     testCases     [2] = QSortTestCase{ input3, correctOutput3 };
 
     for (size_t i = 0; i < QSORT_TESTS_NUMBER; i++)
-        qsort(testCases[i].input, 0, 2, sizeof(string), (int (*)(const void*, const void*)) &strCmpForSortAlphabetically);
+        qsort(testCases[i].input, 0, 2, sizeof(string), getStrComparators(DEFAULT_CODE_PAGE)->alphabetically);
 
     size_t testsPassed = 0;
     for (size_t i = 0; i < QSORT_TESTS_NUMBER; i++)
@@ -146,6 +160,650 @@ void testQSort()
     printTestResult(testsPassed, QSORT_TESTS_NUMBER);
 }
 
+// TESTING qsortRange(void*, size_t, size_t, size_t, size_t, size_t, int (*)(const void*, const void*))
+static const size_t QSORT_RANGE_TESTS_NUMBER = 5;
+static const size_t QSORT_RANGE_VALUES_COUNT = 101;
+
+struct QSortRangeTestCase
+{
+    size_t first = 0;
+    size_t last  = 0;
+};
+
+static int intCmp(const void* value1, const void* value2)
+{
+    return *((const int*) value1) - *((const int*) value2);
+}
+
+void testQSortRange()
+{
+    printFunctionTitle("Testing qsortRange(void*, ..., first, last, cmp)");
+
+    QSortRangeTestCase testCases[QSORT_RANGE_TESTS_NUMBER] = {{0, 9}, {45, 54}, {91, 100}, {0, 100}, {50, 50}};
+
+    int values[QSORT_RANGE_VALUES_COUNT] = {};
+
+    size_t testsPassed = 0;
+    for (size_t i = 0; i < QSORT_RANGE_TESTS_NUMBER; i++)
+    {
+        // permutation of 0..QSORT_RANGE_VALUES_COUNT-1
+        for (size_t j = 0; j < QSORT_RANGE_VALUES_COUNT; j++)
+            values[j] = (int) ((j * 37) % QSORT_RANGE_VALUES_COUNT);
+
+        qsortRange(values, 0, QSORT_RANGE_VALUES_COUNT - 1, sizeof(int), testCases[i].first, testCases[i].last, &intCmp);
+
+        size_t j = testCases[i].first;
+        for (; j <= testCases[i].last; j++)
+            if (values[j] != (int) j)
+                break;
+
+        if (j <= testCases[i].last)
+            consoleWriteFormatted("Test failed: output[%d]=%d, correct output[%d]=%d (range = %d..%d)\n",
+                                  j, values[j], j, j,
+                                  testCases[i].first, testCases[i].last);
+        else
+            testsPassed++;
+    }
+
+    printTestResult(testsPassed, QSORT_RANGE_TESTS_NUMBER);
+}
+
+// TESTING sortedIteratorNext(SortedIterator*)
+static const size_t SORTED_ITERATOR_TESTS_NUMBER = 3;
+
+struct SortedIteratorTestCase
+{
+    size_t count      = 0;
+    size_t multiplier = 0;
+};
+
+void testSortedIterator()
+{
+    printFunctionTitle("Testing sortedIteratorNext(SortedIterator*)");
+
+    SortedIteratorTestCase testCases[SORTED_ITERATOR_TESTS_NUMBER] = {{0, 1}, {1, 1}, {QSORT_RANGE_VALUES_COUNT, 37}};
+
+    int values[QSORT_RANGE_VALUES_COUNT] = {};
+
+    size_t testsPassed = 0;
+    for (size_t i = 0; i < SORTED_ITERATOR_TESTS_NUMBER; i++)
+    {
+        for (size_t j = 0; j < testCases[i].count; j++)
+            values[j] = (int) ((j * testCases[i].multiplier) % testCases[i].count);
+
+        SortedIterator iterator = {};
+        sortedIteratorInit(&iterator, values, testCases[i].count, sizeof(int), &intCmp);
+
+        int*   value   = NULL;
+        size_t yielded = 0;
+        while ((value = (int*) sortedIteratorNext(&iterator)) != NULL && *value == (int) yielded)
+            yielded++;
+
+        int error = iterator.error;
+        sortedIteratorDestroy(&iterator);
+
+        if (value != NULL || yielded != testCases[i].count || error != 0)
+            consoleWriteFormatted("Test failed: yielded %d values in order, correct output=%d values\n",
+                                  yielded, testCases[i].count);
+        else
+            testsPassed++;
+    }
+
+    printTestResult(testsPassed, SORTED_ITERATOR_TESTS_NUMBER);
+}
+
+// TESTING findRhymes(const RhymeIndex*, const unsigned char*, size_t, const size_t**)
+static const size_t FIND_RHYMES_TESTS_NUMBER = 7;
+static const size_t FIND_RHYMES_LINES_COUNT  = 5;
+
+struct FindRhymesTestCase
+{
+    const char* suffix        = NULL;
+    size_t      correctOutput = 0;
+};
+
+void testFindRhymes()
+{
+    printFunctionTitle("Testing findRhymes(index, suffix, length, lines)");
+
+    string lines[FIND_RHYMES_LINES_COUNT] = {};
+    lines[0] = string{(unsigned char*)"    ,", 30};
+    lines[1] = string{(unsigned char*)"    ,",      25};
+    lines[2] = string{(unsigned char*)"   ",        24};
+    lines[3] = string{(unsigned char*)"    .",        24};
+    lines[4] = string{(unsigned char*)"!",                             3};
+
+    FindRhymesTestCase testCases[FIND_RHYMES_TESTS_NUMBER] = {{"", 2}, {"!", 2}, {"", 1}, {"", 0},
+                                                              {"", 1}, {" ", 2}, {"  ", 1}};
+
+    RhymeIndex index = {};
+    buildRhymeIndex(&index, lines, FIND_RHYMES_LINES_COUNT, DEFAULT_CODE_PAGE);
+
+    size_t        testsPassed = 0;
+    const size_t* found       = NULL;
+    for (size_t i = 0; i < FIND_RHYMES_TESTS_NUMBER; i++)
+    {
+        size_t output = findRhymes(&index, (const unsigned char*) testCases[i].suffix, 
+                                   strLength(testCases[i].suffix), &found);
+        if (output != testCases[i].correctOutput)
+            consoleWriteFormatted("Test failed: output=%d, correct output=%d (input = \"%s\")\n", 
+                                  output, 
+                                  testCases[i].correctOutput, 
+                                  testCases[i].suffix);
+        else
+            testsPassed++;
+    }
+
+    destroyRhymeIndex(&index);
+
+    printTestResult(testsPassed, FIND_RHYMES_TESTS_NUMBER);
+}
+
+// TESTING removeDuplicates(string*, size_t*, size_t*, CodePage)
+static const size_t REMOVE_DUPLICATES_LINES_COUNT  = 6;
+static const size_t REMOVE_DUPLICATES_UNIQUE_COUNT = 3;
+
+void testRemoveDuplicates()
+{
+    printFunctionTitle("Testing removeDuplicates(lines, &n, occurrences)");
+
+    string lines        [REMOVE_DUPLICATES_LINES_COUNT]  = {};
+    string correctOutput[REMOVE_DUPLICATES_UNIQUE_COUNT] = {};
+    lines[0] = string{(unsigned char*)"   ,",    22};
+    lines[1] = string{(unsigned char*)"  ;",      20};
+    lines[2] = string{(unsigned char*)"   ",     21};
+    lines[3] = string{(unsigned char*)",  ,  ,", 26};
+    lines[4] = string{(unsigned char*)"- ,   !",  25};
+    lines[5] = string{(unsigned char*)"  ",       19};
+    correctOutput[0] = lines[0];
+    correctOutput[1] = lines[1];
+    correctOutput[2] = lines[3];
+
+    size_t correctOccurrences[REMOVE_DUPLICATES_UNIQUE_COUNT] = {3, 2, 1};
+    size_t occurrences       [REMOVE_DUPLICATES_LINES_COUNT]  = {};
+
+    size_t output = REMOVE_DUPLICATES_LINES_COUNT;
+    int    result = removeDuplicates(lines, &output, occurrences, DEFAULT_CODE_PAGE);
+
+    size_t testsPassed = 0;
+    if (result != 0 || output != REMOVE_DUPLICATES_UNIQUE_COUNT)
+        consoleWriteFormatted("Test failed: output=%d, correct output=%d\n", output, REMOVE_DUPLICATES_UNIQUE_COUNT);
+    else
+        testsPassed++;
+
+    for (size_t i = 0; i < REMOVE_DUPLICATES_UNIQUE_COUNT; i++)
+    {
+        if (lines[i].str != correctOutput[i].str || occurrences[i] != correctOccurrences[i])
+            consoleWriteFormatted("Test failed: line %d is \"%s\" (x%d), correct line is \"%s\" (x%d)\n", 
+                                  i, lines[i].str, occurrences[i], correctOutput[i].str, correctOccurrences[i]);
+        else
+            testsPassed++;
+    }
+
+    printTestResult(testsPassed, REMOVE_DUPLICATES_UNIQUE_COUNT + 1);
+}
+
+// TESTING findStrIndexRange(const string*, size_t, const string*, cmp, size_t*)
+static const size_t FIND_STR_INDEX_RANGE_TESTS_NUMBER = 5;
+static const size_t FIND_STR_INDEX_RANGE_LINES_COUNT  = 6;
+
+struct FindStrIndexRangeTestCase
+{
+    const char* prefix        = NULL;
+    size_t      correctFirst  = 0;
+    size_t      correctOutput = 0;
+};
+
+void testFindStrIndexRange()
+{
+    printFunctionTitle("Testing findStrIndexRange(lines, n, key, cmp)");
+
+    string lines[FIND_STR_INDEX_RANGE_LINES_COUNT] = {};
+    lines[0] = string{(unsigned char*)"   ",        24};
+    lines[1] = string{(unsigned char*)"    ,", 30};
+    lines[2] = string{(unsigned char*)"    .",        24};
+    lines[3] = string{(unsigned char*)"   - ,",     27};
+    lines[4] = string{(unsigned char*)"    ,",      25};
+    lines[5] = string{(unsigned char*)"!",                             3};
+
+    sortStrIndex(lines, FIND_STR_INDEX_RANGE_LINES_COUNT,
+                 getStrComparators(DEFAULT_CODE_PAGE)->alphabetically, 0);
+
+    FindStrIndexRangeTestCase testCases[FIND_STR_INDEX_RANGE_TESTS_NUMBER] = 
+        {{"", 3, 2}, {", ", 3, 1}, {"", 0, 1}, {"", 0, 6}, {"", 6, 0}};
+
+    size_t testsPassed = 0;
+    for (size_t i = 0; i < FIND_STR_INDEX_RANGE_TESTS_NUMBER; i++)
+    {
+        string key    = { (unsigned char*) testCases[i].prefix, strLength(testCases[i].prefix) };
+        size_t first  = 0;
+        size_t output = findStrIndexRange(lines, FIND_STR_INDEX_RANGE_LINES_COUNT, &key,
+                                          getStrComparators(DEFAULT_CODE_PAGE)->prefix, &first);
+        if (output != testCases[i].correctOutput || first != testCases[i].correctFirst)
+            consoleWriteFormatted("Test failed: output=%d (from %d), correct output=%d (from %d) (input = \"%s\")\n", 
+                                  output,                     first,
+                                  testCases[i].correctOutput, testCases[i].correctFirst,
+                                  testCases[i].prefix);
+        else
+            testsPassed++;
+    }
+
+    printTestResult(testsPassed, FIND_STR_INDEX_RANGE_TESTS_NUMBER);
+}
+
+// TESTING collationWeight<CodePage>(unsigned char)
+static const size_t COLLATION_WEIGHT_TESTS_NUMBER = 3;
+
+template <CodePage codePage>
+static bool isAlphabetCollatedCorrectly(const char* codePageName)
+{
+    const CodePageLetters* letters = &CODE_PAGE_LETTERS[codePage];
+
+    for (size_t i = 0; i < ALPHABET_LENGTH; i++)
+    {
+        uint16_t lowerWeight = collationWeight<codePage>(letters->lower[i]);
+        uint16_t upperWeight = collationWeight<codePage>(letters->upper[i]);
+        uint16_t prevWeight  = i == 0 ? 0 : collationWeight<codePage>(letters->lower[i - 1]);
+
+        if (lowerWeight != upperWeight || lowerWeight <= prevWeight || 
+            lowerCaseSymbol<codePage>(letters->upper[i]) != letters->lower[i])
+        {
+            consoleWriteFormatted("Test failed: letter %d of %s is collated incorrectly\n", i, codePageName);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void testCollationWeight()
+{
+    printFunctionTitle("Testing collationWeight<codePage>(symbol)");
+
+    size_t testsPassed = 0;
+    testsPassed += isAlphabetCollatedCorrectly<CODE_PAGE_CP1251>    ("CP1251");
+    testsPassed += isAlphabetCollatedCorrectly<CODE_PAGE_KOI8_R>    ("KOI8-R");
+    testsPassed += isAlphabetCollatedCorrectly<CODE_PAGE_ISO_8859_5>("ISO-8859-5");
+
+    printTestResult(testsPassed, COLLATION_WEIGHT_TESTS_NUMBER);
+}
+
+// TESTING strCmpAlphabetically and strCmpReversely on lines of several COMPARE_BLOCK_SIZE blocks
+static const size_t BLOCK_BOUNDARIES_TESTS_NUMBER = 8;
+
+struct BlockBoundariesTestCase
+{
+    const char* line1       = NULL;
+    const char* line2       = NULL;
+    int         correctSign = 0;
+};
+
+static int sign(int number)
+{
+    return (number > 0) - (number < 0);
+}
+
+void testBlockBoundaries()
+{
+    printFunctionTitle("Testing comparators on block boundaries");
+
+    // lines differ right before or right after the first COMPARE_BLOCK_SIZE
+    // bytes from the left (alphabetical order) or from the right (reverse
+    // one), some of them also differ in case and punctuation marks before it
+    BlockBoundariesTestCase testCases[2][BLOCK_BOUNDARIES_TESTS_NUMBER] = 
+        {{{"",   "",    -1},
+          {"",   "",     1},
+          {"",   "",    -1},
+          {", ", ".-",   0},
+          {" ", ", ",  0},
+          {"",  "",    -1},
+          {",",    "",     -1},
+          {"",   "",    -1}},
+         {{"",   "",    -1},
+          {"",   "",     1},
+          {"",   "",    -1},
+          {", ", ".-",   0},
+          {", ", " ",    0},
+          {"",  "",     -1},
+          {",",    "",     -1},
+          {"",   "",    -1}}};
+
+    const StrComparators* comparators = getStrComparators(DEFAULT_CODE_PAGE);
+    int (*compare[2])(const void*, const void*) = { comparators->alphabetically, comparators->reversely };
+
+    size_t testsPassed = 0;
+    for (size_t i = 0; i < BLOCK_BOUNDARIES_TESTS_NUMBER; i++)
+    {
+        bool isCorrect = true;
+        for (size_t order = 0; order < 2; order++)
+        {
+            BlockBoundariesTestCase* testCase = &testCases[order][i];
+
+            string line1 = { (unsigned char*) testCase->line1, strLength(testCase->line1) };
+            string line2 = { (unsigned char*) testCase->line2, strLength(testCase->line2) };
+            if (sign(compare[order](&line1, &line2)) !=  testCase->correctSign ||
+                sign(compare[order](&line2, &line1)) != -testCase->correctSign)
+            {
+                consoleWriteFormatted("Test failed: \"%s\" and \"%s\" are compared incorrectly, correct "
+                                      "sign=%d\n", testCase->line1, testCase->line2, testCase->correctSign);
+                isCorrect = false;
+            }
+        }
+
+        testsPassed += isCorrect;
+    }
+
+    printTestResult(testsPassed, BLOCK_BOUNDARIES_TESTS_NUMBER);
+}
+
+// TESTING qsort(void*, size_t, size_t, size_t, cmp) on large inputs
+static const size_t QSORT_SCALING_LINES_COUNT        = 1000000;
+static const size_t QSORT_SCALING_SIZES_RATIO        = 4;
+static const size_t QSORT_SCALING_LINE_LENGTH        = 7;
+static const double QSORT_SCALING_COMPARISONS_FACTOR = 2;
+static const double QSORT_SCALING_MAX_TIME_RATIO     = 2 * QSORT_SCALING_SIZES_RATIO;
+
+enum QSortScalingInput
+{
+    SORTED_INPUT,
+    REVERSED_INPUT,
+    DUPLICATE_INPUT,
+    RANDOM_INPUT,
+    SCALING_INPUTS_NUMBER
+};
+
+static const char* QSORT_SCALING_INPUT_NAMES[SCALING_INPUTS_NUMBER] = { "sorted", "reversed", "all-duplicate", "random" };
+
+static size_t comparisonsCount = 0;
+
+static int countingStrCmp(const void* str1, const void* str2)
+{
+    comparisonsCount++;
+    return getStrComparators(DEFAULT_CODE_PAGE)->alphabetically(str1, str2);
+}
+
+//-----------------------------------------------------------------------------
+//! Generates count lines of QSORT_SCALING_LINE_LENGTH digits in buffer, which
+//! are numbers from 0 to count - 1 in the order given by input.
+//-----------------------------------------------------------------------------
+static void generateScalingLines(unsigned char* buffer, string* lines, size_t count, QSortScalingInput input)
+{
+    size_t random = 1;
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t number = 0;
+        switch (input)
+        {
+            case SORTED_INPUT:    number = i;             break;
+            case REVERSED_INPUT:  number = count - 1 - i; break;
+            case DUPLICATE_INPUT: number = 0;             break;
+            default:
+                random = random * 6364136223846793005u + 1442695040888963407u;
+                number = (random >> 33) % count;
+                break;
+        }
+
+        unsigned char* line = buffer + i * QSORT_SCALING_LINE_LENGTH;
+        for (size_t j = QSORT_SCALING_LINE_LENGTH; j > 0; j--, number /= 10)
+            line[j - 1] = (unsigned char) ('0' + number % 10);
+
+        lines[i] = string{line, QSORT_SCALING_LINE_LENGTH};
+    }
+}
+
+//-----------------------------------------------------------------------------
+//! Sorts count generated lines.
+//!
+//! @return time of sorting in seconds.
+//-----------------------------------------------------------------------------
+static double timeScalingSort(unsigned char* buffer, string* lines, size_t count, QSortScalingInput input)
+{
+    generateScalingLines(buffer, lines, count, input);
+
+    clock_t start = clock();
+    qsort(lines, 0, count - 1, sizeof(string), getStrComparators(DEFAULT_CODE_PAGE)->alphabetically);
+
+    return (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+//-----------------------------------------------------------------------------
+//! Sorts count generated lines counting the comparisons.
+//!
+//! @return number of comparisons.
+//-----------------------------------------------------------------------------
+static size_t countScalingComparisons(unsigned char* buffer, string* lines, size_t count, QSortScalingInput input)
+{
+    generateScalingLines(buffer, lines, count, input);
+    comparisonsCount = 0;
+
+    qsort(lines, 0, count - 1, sizeof(string), &countingStrCmp);
+
+    return comparisonsCount;
+}
+
+void testQSortScaling()
+{
+    printFunctionTitle("Testing qsort(...) on 10^6 lines");
+
+    unsigned char* buffer = (unsigned char*) calloc(QSORT_SCALING_LINES_COUNT, QSORT_SCALING_LINE_LENGTH);
+    string*        lines  = (string*)        calloc(QSORT_SCALING_LINES_COUNT, sizeof(string));
+    assert(buffer != NULL);
+    assert(lines  != NULL);
+
+    size_t testsPassed    = 0;
+    size_t smallCount     = QSORT_SCALING_LINES_COUNT / QSORT_SCALING_SIZES_RATIO;
+    double maxComparisons = QSORT_SCALING_COMPARISONS_FACTOR * QSORT_SCALING_LINES_COUNT * 
+                            log2((double) QSORT_SCALING_LINES_COUNT);
+
+    for (size_t i = 0; i < SCALING_INPUTS_NUMBER; i++)
+    {
+        QSortScalingInput input = (QSortScalingInput) i;
+
+        double smallTime   = timeScalingSort        (buffer, lines, smallCount,                input);
+        double largeTime   = timeScalingSort        (buffer, lines, QSORT_SCALING_LINES_COUNT, input);
+        size_t comparisons = countScalingComparisons(buffer, lines, QSORT_SCALING_LINES_COUNT, input);
+
+        size_t line = 1;
+        for (; line < QSORT_SCALING_LINES_COUNT; line++)
+            if (getStrComparators(DEFAULT_CODE_PAGE)->alphabetically(&lines[line - 1], &lines[line]) > 0)
+                break;
+
+        bool isPassed = true;
+        if (line < QSORT_SCALING_LINES_COUNT)
+        {
+            consoleWriteFormatted("Test failed: %s input isn't sorted at line %d\n", 
+                                  QSORT_SCALING_INPUT_NAMES[input], line);
+            isPassed = false;
+        }
+
+        if (comparisons > maxComparisons)
+        {
+            consoleWriteFormatted("Test failed: %s input took %d comparisons, more than %d\n", 
+                                  QSORT_SCALING_INPUT_NAMES[input], comparisons, (size_t) maxComparisons);
+            isPassed = false;
+        }
+
+        // n log n makes the ratio a bit more than QSORT_SCALING_SIZES_RATIO, n^2 - its square
+        if (largeTime > QSORT_SCALING_MAX_TIME_RATIO * smallTime && largeTime > 0.01)
+        {
+            consoleWriteFormatted("Test failed: %s input took %d ms, %d lines took %d ms\n", 
+                                  QSORT_SCALING_INPUT_NAMES[input], (int) (largeTime * 1000), 
+                                  smallCount, (int) (smallTime * 1000));
+            isPassed = false;
+        }
+
+        testsPassed += isPassed;
+    }
+
+    free(buffer);
+    free(lines);
+
+    printTestResult(testsPassed, SCALING_INPUTS_NUMBER);
+}
+
+// TESTING cleanNovel(unsigned char*, size_t, unsigned char*, CodePage) without '\n' at the end
+static const size_t CLEAN_NOVEL_LAST_LINE_TESTS_NUMBER = 3;
+
+struct CleanNovelLastLineTestCase
+{
+    const char* input         = NULL;
+    const char* correctOutput = NULL;
+};
+
+void testCleanNovelLastLine()
+{
+    printFunctionTitle("Testing cleanNovel(...) without last '\\n'");
+
+    CleanNovelLastLineTestCase testCases[CLEAN_NOVEL_LAST_LINE_TESTS_NUMBER] = 
+        {{" 1\n \n\n ", " \n \n"},
+         {" \n 2",                  " \n"},
+         {" \n123",                      " \n"}};
+
+    size_t testsPassed = 0;
+    for (size_t i = 0; i < CLEAN_NOVEL_LAST_LINE_TESTS_NUMBER; i++)
+    {
+        // no terminating symbol in the input, so reading past it would be noticed by sanitizers
+        size_t         inputSize = strLength(testCases[i].input);
+        unsigned char* input     = (unsigned char*) calloc(inputSize, sizeof(unsigned char));
+        unsigned char* output    = (unsigned char*) calloc(inputSize + 2, sizeof(unsigned char));
+        assert(input  != NULL);
+        assert(output != NULL);
+
+        for (size_t j = 0; j < inputSize; j++)
+            input[j] = (unsigned char) testCases[i].input[j];
+
+        size_t outputSize = cleanNovel(input, inputSize, output, DEFAULT_CODE_PAGE);
+        if (outputSize != strLength(testCases[i].correctOutput) + 1 || 
+            strCompare(output, (const unsigned char*) testCases[i].correctOutput) != 0)
+            consoleWriteFormatted("Test failed: output=\"%s\", correct output=\"%s\"\n", 
+                                  output, testCases[i].correctOutput);
+        else
+            testsPassed++;
+
+        free(input);
+        free(output);
+    }
+
+    printTestResult(testsPassed, CLEAN_NOVEL_LAST_LINE_TESTS_NUMBER);
+}
+
+// TESTING cleanNovel, sortStrIndex and buildRhymeIndex in every CodePage
+static const size_t CODE_PAGES_TEXT_LINES = 6;
+
+struct CodePagesTestCase
+{
+    CodePage    codePage = DEFAULT_CODE_PAGE;
+    const char* input    = NULL;
+};
+
+void testCodePages()
+{
+    printFunctionTitle("Testing cleaning and sorting in every code page");
+
+    // the same text in every code page, its cleaned lines are:
+    // 0 " ,", 1 " ,", 2 " ", 3 "  .", 4 " -- ;", 5 " ."
+    CodePagesTestCase testCases[CODE_PAGES_NUMBER] = 
+        {{CODE_PAGE_CP1251,
+          " 1\n"
+          " ,\n"
+          "Chapter I\n"
+          " ,\n"
+          " \n"
+          "  .\n"
+          " -- ;\n"
+          " .\n"},
+         {CODE_PAGE_KOI8_R,
+          "\xE7\xCC\xC1\xD7\xC1 1\n"
+          "\xED\xCF\xCA \xC4\xD1\xC4\xD1,\n"
+          "Chapter I\n"
+          "\xEB\xCF\xC7\xC4\xC1 \xDA\xC1\xCE\xC5\xCD\xCF\xC7,\n"
+          "\xEF\xCE \xDA\xC1\xD3\xD4\xC1\xD7\xC9\xCC\n"
+          "\xE9 \xCE\xC5 \xCD\xCF\xC7.\n"
+          "\xB3\xCC\xCB\xC1 -- \xC5\xCC\xD8;\n"
+          "\xE5\xC7\xCF \xCE\xC1\xD5\xCB\xC1.\n"},
+         {CODE_PAGE_ISO_8859_5,
+          "\xB3\xDB\xD0\xD2\xD0 1\n"
+          "\xBC\xDE\xD9 \xD4\xEF\xD4\xEF,\n"
+          "Chapter I\n"
+          "\xBA\xDE\xD3\xD4\xD0 \xD7\xD0\xDD\xD5\xDC\xDE\xD3,\n"
+          "\xBE\xDD \xD7\xD0\xE1\xE2\xD0\xD2\xD8\xDB\n"
+          "\xB8 \xDD\xD5 \xDC\xDE\xD3.\n"
+          "\xA1\xDB\xDA\xD0 -- \xD5\xDB\xEC;\n"
+          "\xB5\xD3\xDE \xDD\xD0\xE3\xDA\xD0.\n"}};
+
+    // alphabetical and reverse orders of the lines
+    size_t correctOrders[2][CODE_PAGES_TEXT_LINES] = {{ 5, 4, 3, 1, 0, 2 },
+                                                      { 5, 1, 3, 2, 4, 0 }};
+
+    size_t testsPassed = 0;
+    for (size_t i = 0; i < CODE_PAGES_NUMBER; i++)
+    {
+        CodePage codePage = testCases[i].codePage;
+        int    (*comparators[2])(const void*, const void*) = { getStrComparators(codePage)->alphabetically,
+                                                              getStrComparators(codePage)->reversely };
+
+        size_t         inputSize = strLength(testCases[i].input);
+        unsigned char* input     = (unsigned char*) calloc(inputSize + 1, sizeof(unsigned char));
+        unsigned char* output    = (unsigned char*) calloc(inputSize + 2, sizeof(unsigned char));
+        assert(input  != NULL);
+        assert(output != NULL);
+
+        for (size_t j = 0; j < inputSize; j++)
+            input[j] = (unsigned char) testCases[i].input[j];
+
+        size_t outputSize    = cleanNovel(input, inputSize, output, codePage);
+        size_t numberOfLines = strNumOfOccurrences((const char*) output, '\n');
+
+        string lines      [CODE_PAGES_TEXT_LINES] = {};
+        string sortedLines[CODE_PAGES_TEXT_LINES] = {};
+        size_t lineStart = 0;
+        for (size_t j = 0, line = 0; j < outputSize && line < CODE_PAGES_TEXT_LINES; j++)
+        {
+            if (output[j] != '\n')
+                continue;
+
+            lines[line++] = { output + lineStart, j - lineStart };
+            lineStart     = j + 1;
+        }
+
+        bool isCorrect = numberOfLines == CODE_PAGES_TEXT_LINES;
+
+        for (size_t order = 0; order < 2 && isCorrect; order++)
+        {
+            for (size_t line = 0; line < CODE_PAGES_TEXT_LINES; line++)
+                sortedLines[line] = lines[line];
+
+            sortStrIndex(sortedLines, CODE_PAGES_TEXT_LINES, comparators[order], 0);
+
+            for (size_t line = 0; line < CODE_PAGES_TEXT_LINES; line++)
+                if (sortedLines[line].str != lines[correctOrders[order][line]].str)
+                    isCorrect = 0;
+        }
+
+        // "" and " " rhyme
+        RhymeIndex    rhymeIndex = {};
+        const size_t* rhymes     = NULL;
+        if (isCorrect)
+        {
+            buildRhymeIndex(&rhymeIndex, lines, CODE_PAGES_TEXT_LINES, codePage);
+            isCorrect = findLineRhymes(&rhymeIndex, 1, &rhymes) == 2;
+            destroyRhymeIndex(&rhymeIndex);
+        }
+
+        if (!isCorrect)
+            consoleWriteFormatted("Test failed: code page %s, %d lines cleaned, correct output=%d lines "
+                                  "in the right orders with 2 rhymes\n",
+                                  CODE_PAGE_NAMES[codePage], numberOfLines, CODE_PAGES_TEXT_LINES);
+        else
+            testsPassed++;
+
+        free(input);
+        free(output);
+    }
+
+    printTestResult(testsPassed, CODE_PAGES_NUMBER);
+}
+
 //TESTING toLowerCase(unsigned char)
 static const size_t TOLOWERCASE_TESTS_NUMBER = 4;
 
@@ -3,6 +3,16 @@
 void testAll                ();
 void testSwap               ();
 void testQSort              ();
+void testQSortRange         ();
+void testSortedIterator     ();
+void testFindRhymes         ();
+void testRemoveDuplicates   ();
+void testFindStrIndexRange  ();
+void testCollationWeight    ();
+void testBlockBoundaries    ();
+void testQSortScaling       ();
+void testCleanNovelLastLine ();
+void testCodePages          ();
 void testToLowerCase        ();
 void testStrNumOfOccurrences();
 void testIsCyrilicLetter    ();